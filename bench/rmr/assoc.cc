@@ -14,6 +14,8 @@
 
 #include <benchmark/benchmark.h>
 
+#include <rmr/frozen_trie_set.h>
+#include <rmr/hat_trie_set.h>
 #include <rmr/trie_set.h>
 #include <rmr/tst_set.h>
 
@@ -24,6 +26,14 @@ struct alpha {
 struct trie_set : rmr::trie_set<26, alpha> { using rmr::trie_set<26, alpha>::trie_set; };
 struct tst_set  : rmr::tst_set<>    { using rmr::tst_set<>::tst_set;      };
 
+struct pooled_trie_set : rmr::trie_set<26, alpha, std::string, std::allocator<std::string>, rmr::pooled_nodes>
+{ using trie_set::trie_set; };
+struct pooled_tst_set  : rmr::tst_set<std::less<char>, std::string, std::allocator<std::string>, rmr::pooled_nodes>
+{ using tst_set::tst_set; };
+struct adaptive_trie_set : rmr::trie_set<26, alpha, std::string, std::allocator<std::string>, rmr::adaptive_nodes>
+{ using trie_set::trie_set; };
+struct hat_trie_set : rmr::hat_trie_set<26, alpha> { using rmr::hat_trie_set<26, alpha>::hat_trie_set; };
+
 namespace bench {
 
 std::vector<std::size_t> random_indices(std::size_t n, std::size_t max) {
@@ -43,7 +53,7 @@ std::vector<std::string> random_words(std::size_t n) {
         std::istreambuf_iterator<char>(words_file), std::istreambuf_iterator<char>(), '\n'
     );
 
-    auto indices = random_indices(n, word_count);
+    auto indices = random_indices(n, word_count - 1);
 
     words_file.clear();
     words_file.seekg(0, std::ios::beg);
@@ -53,7 +63,7 @@ std::vector<std::string> random_words(std::size_t n) {
     for (std::size_t current_line = 0; current_line < word_count; current_line++) {
         std::string line;
         std::getline(words_file, line);
-        if (current_line == indices[target_line]) {
+        while (target_line < indices.size() && current_line == indices[target_line]) {
             words.push_back(line);
             target_line++;
         }
@@ -83,3 +93,80 @@ void insertion(benchmark::State& state) {
 
 ARMOR_TEMPLATE_BENCHMARK(insertion, trie_set)->RangeMultiplier(10)->Range(10, 100000);
 ARMOR_TEMPLATE_BENCHMARK(insertion,  tst_set)->RangeMultiplier(10)->Range(10, 100000);
+ARMOR_TEMPLATE_BENCHMARK(insertion, pooled_trie_set)->RangeMultiplier(10)->Range(10, 100000);
+ARMOR_TEMPLATE_BENCHMARK(insertion,  pooled_tst_set)->RangeMultiplier(10)->Range(10, 100000);
+ARMOR_TEMPLATE_BENCHMARK(insertion, adaptive_trie_set)->RangeMultiplier(10)->Range(10, 100000);
+ARMOR_TEMPLATE_BENCHMARK(insertion, hat_trie_set)->RangeMultiplier(10)->Range(10, 100000);
+
+// The words file is sorted, so the words can be handed over as sorted input.
+template <typename T>
+void sorted_construction(benchmark::State& state) {
+    auto words = bench::random_words(state.range(0));
+
+    for (auto _ : state) {
+        T t(rmr::sorted_input, words.begin(), words.end());
+        benchmark::DoNotOptimize(t.size());
+    }
+}
+
+ARMOR_TEMPLATE_BENCHMARK(sorted_construction, trie_set)->RangeMultiplier(10)->Range(10, 100000);
+ARMOR_TEMPLATE_BENCHMARK(sorted_construction,  tst_set)->RangeMultiplier(10)->Range(10, 100000);
+
+template <typename T>
+void lookup(benchmark::State& state) {
+    auto words = bench::random_words(state.range(0));
+    T t(words.begin(), words.end());
+    std::shuffle(words.begin(), words.end(), std::default_random_engine(42));
+
+    for (auto _ : state) {
+        for (auto& w : words) benchmark::DoNotOptimize(t.find(w));
+    }
+}
+
+ARMOR_TEMPLATE_BENCHMARK(lookup, trie_set)->RangeMultiplier(10)->Range(10, 100000);
+ARMOR_TEMPLATE_BENCHMARK(lookup,  tst_set)->RangeMultiplier(10)->Range(10, 100000);
+ARMOR_TEMPLATE_BENCHMARK(lookup, hat_trie_set)->RangeMultiplier(10)->Range(10, 100000);
+
+void lookup_frozen_trie_set(benchmark::State& state) {
+    auto words = bench::random_words(state.range(0));
+    auto t = rmr::freeze(trie_set(words.begin(), words.end()));
+    std::shuffle(words.begin(), words.end(), std::default_random_engine(42));
+
+    for (auto _ : state) {
+        for (auto& w : words) benchmark::DoNotOptimize(t.find(w));
+    }
+}
+
+BENCHMARK(lookup_frozen_trie_set)->RangeMultiplier(10)->Range(10, 100000);
+
+template <typename T>
+void batched_lookup(benchmark::State& state) {
+    auto words = bench::random_words(state.range(0));
+    T t(words.begin(), words.end());
+    std::shuffle(words.begin(), words.end(), std::default_random_engine(42));
+    std::vector<typename T::const_iterator> found(words.size());
+
+    for (auto _ : state) {
+        t.find_many(words.begin(), words.end(), found.begin());
+        benchmark::DoNotOptimize(found.data());
+    }
+}
+
+ARMOR_TEMPLATE_BENCHMARK(batched_lookup, trie_set)->RangeMultiplier(10)->Range(10, 100000);
+ARMOR_TEMPLATE_BENCHMARK(batched_lookup,  tst_set)->RangeMultiplier(10)->Range(10, 100000);
+ARMOR_TEMPLATE_BENCHMARK(batched_lookup, adaptive_trie_set)->RangeMultiplier(10)->Range(10, 100000);
+ARMOR_TEMPLATE_BENCHMARK(lookup, adaptive_trie_set)->RangeMultiplier(10)->Range(10, 100000);
+
+template <typename T>
+void iteration(benchmark::State& state) {
+    auto words = bench::random_words(state.range(0));
+    T t(words.begin(), words.end());
+
+    for (auto _ : state) {
+        for (auto& w : t) benchmark::DoNotOptimize(w);
+    }
+}
+
+ARMOR_TEMPLATE_BENCHMARK(iteration, trie_set)->RangeMultiplier(10)->Range(10, 100000);
+ARMOR_TEMPLATE_BENCHMARK(iteration,  tst_set)->RangeMultiplier(10)->Range(10, 100000);
+ARMOR_TEMPLATE_BENCHMARK(iteration, hat_trie_set)->RangeMultiplier(10)->Range(10, 100000);
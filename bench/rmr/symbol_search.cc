@@ -0,0 +1,66 @@
+// Armor
+//
+// Copyright Ron Mordechai, 2018
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <rmr/detail/symbol_search.h>
+
+namespace bench {
+
+struct sparse_node {
+    std::uint8_t keys[16];
+};
+
+// Sparse nodes of the given size holding sorted random symbols, and symbols to look up in them
+// of which about half are present.
+struct search_fixture {
+    std::vector<sparse_node> nodes;
+    std::vector<std::uint8_t> symbols;
+
+    explicit search_fixture(std::size_t count) : nodes(1024), symbols(nodes.size()) {
+        std::default_random_engine engine(42);
+        std::vector<std::uint8_t> alphabet(127);
+        std::iota(alphabet.begin(), alphabet.end(), 0);
+
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            std::shuffle(alphabet.begin(), alphabet.end(), engine);
+            std::sort(alphabet.begin(), alphabet.begin() + count);
+            std::copy(alphabet.begin(), alphabet.begin() + 16, nodes[i].keys);
+            symbols[i] = alphabet[engine() % (2 * count)];
+        }
+    }
+};
+
+} // namespace bench
+
+template <bool Simd>
+void child_search(benchmark::State& state) {
+    std::size_t count = state.range(0);
+    bench::search_fixture f(count);
+
+    for (auto _ : state) {
+        std::size_t found = 0;
+        for (std::size_t i = 0; i < f.nodes.size(); ++i) {
+            if constexpr (Simd) found += rmr::detail::find_symbol(f.nodes[i].keys, count, f.symbols[i]);
+            else         found += rmr::detail::find_symbol_scalar(f.nodes[i].keys, count, f.symbols[i]);
+        }
+        benchmark::DoNotOptimize(found);
+    }
+    state.SetItemsProcessed(state.iterations() * f.nodes.size());
+}
+
+void child_search_scalar(benchmark::State& s) { child_search<false>(s); }
+void child_search_simd(benchmark::State& s)   { child_search<true>(s); }
+
+BENCHMARK(child_search_scalar)->DenseRange(2, 16, 2);
+BENCHMARK(child_search_simd)->DenseRange(2, 16, 2);
@@ -0,0 +1,367 @@
+// Armor
+//
+// Copyright Ron Mordechai, 2018
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <type_traits>
+
+#include <rmr/detail/symbol_search.h>
+#include <rmr/detail/util.h>
+
+namespace rmr::detail {
+
+// A trie node whose children grow and shrink between four layouts, in the spirit of the Adaptive
+// Radix Tree: up to 4 sorted children stored inline in the node, up to 16 sorted children in a
+// sparse block, up to 48 children behind an R byte index, and a dense block of R children.
+// Only the child block is reallocated when the layout changes, so nodes never move.
+template <typename T, std::size_t R>
+struct adaptive_trie_node {
+    static_assert(R <= std::numeric_limits<std::uint32_t>::max(), "Radix is too large");
+
+    using value_type  = T;
+    using symbol_type = trie_symbol_t<R>;
+
+    enum kind_type : std::uint8_t { inline_kind, sparse_kind, indexed_kind, dense_kind };
+    static constexpr std::size_t inline_capacity  = 4;
+    static constexpr std::size_t sparse_capacity  = 16;
+    static constexpr std::size_t indexed_capacity = 48;
+
+    adaptive_trie_node* parent;
+    T*                  value;
+    std::uint32_t       parent_index;
+    std::uint32_t       count;
+    kind_type           kind;
+    symbol_type         keys[inline_capacity];
+    union {
+        adaptive_trie_node* children[inline_capacity];
+        void*               block;
+    };
+};
+
+template <typename Node>
+struct adaptive_sparse_block {
+    typename Node::symbol_type keys[Node::sparse_capacity];
+    Node*                      children[Node::sparse_capacity];
+};
+
+template <typename Node, std::size_t R>
+struct adaptive_indexed_block {
+    std::uint8_t index[R]; // slot + 1, or 0 for no child
+    Node*        children[Node::indexed_capacity];
+};
+
+template <typename Node, std::size_t R>
+struct adaptive_dense_block {
+    Node* children[R];
+};
+
+template <typename T, std::size_t R>
+struct adaptive_trie_layout {
+    using node_type     = adaptive_trie_node<T, R>;
+    using symbol_type   = typename node_type::symbol_type;
+    using kind_type     = typename node_type::kind_type;
+    using sparse_block  = adaptive_sparse_block<node_type>;
+    using indexed_block = adaptive_indexed_block<node_type, R>;
+    using dense_block   = adaptive_dense_block<node_type, R>;
+
+    static constexpr std::size_t radix = R;
+
+    static void init(node_type* n) {
+        n->count = 0;
+        n->kind  = node_type::inline_kind;
+        std::fill(std::begin(n->children), std::end(n->children), nullptr);
+    }
+    static void init_base(node_type* base, node_type* root) {
+        init(base);
+        base->keys[0] = 0;
+        base->children[0] = root;
+        base->count = 1;
+    }
+
+    static node_type* child(const node_type* n, std::size_t i) {
+        switch (n->kind) {
+        case node_type::inline_kind:
+            return find_child(n->keys, n->children, n->count, i);
+        case node_type::sparse_kind: {
+            auto b = static_cast<const sparse_block*>(n->block);
+            return find_child(b->keys, b->children, n->count, i);
+        }
+        case node_type::indexed_kind: {
+            auto b = static_cast<const indexed_block*>(n->block);
+            return b->index[i] == 0 ? nullptr : b->children[b->index[i] - 1];
+        }
+        default:
+            return static_cast<const dense_block*>(n->block)->children[i];
+        }
+    }
+
+    // Only the node can be fetched ahead, finding the slot of i needs its kind and block.
+    static void prefetch(const node_type* n, std::size_t) { detail::prefetch(n); }
+
+    // The smallest index at or after pos which has a child, or R.
+    static std::size_t next(const node_type* n, std::size_t pos) {
+        switch (n->kind) {
+        case node_type::inline_kind:
+            return next_sorted(n->keys, n->count, pos);
+        case node_type::sparse_kind:
+            return next_sorted(static_cast<const sparse_block*>(n->block)->keys, n->count, pos);
+        case node_type::indexed_kind: {
+            auto b = static_cast<const indexed_block*>(n->block);
+            while (pos < R && b->index[pos] == 0) ++pos;
+            return pos;
+        }
+        default: {
+            auto b = static_cast<const dense_block*>(n->block);
+            while (pos < R && b->children[pos] == nullptr) ++pos;
+            return pos;
+        }
+        }
+    }
+
+    // The largest index before pos which has a child, or R.
+    static std::size_t prev(const node_type* n, std::size_t pos) {
+        switch (n->kind) {
+        case node_type::inline_kind:
+            return prev_sorted(n->keys, n->count, pos);
+        case node_type::sparse_kind:
+            return prev_sorted(static_cast<const sparse_block*>(n->block)->keys, n->count, pos);
+        case node_type::indexed_kind: {
+            auto b = static_cast<const indexed_block*>(n->block);
+            while (pos > 0) if (b->index[--pos] != 0) return pos;
+            return R;
+        }
+        default: {
+            auto b = static_cast<const dense_block*>(n->block);
+            while (pos > 0) if (b->children[--pos] != nullptr) return pos;
+            return R;
+        }
+        }
+    }
+
+    static std::size_t count(const node_type* n) { return n->count; }
+
+    template <typename Allocator>
+    static void attach(Allocator& alloc, node_type* n, std::size_t i, node_type* c) {
+        if (n->count == capacity(n->kind)) convert(alloc, n, grown_kind(n->kind));
+
+        switch (n->kind) {
+        case node_type::inline_kind:
+            insert_sorted(n->keys, n->children, n->count, i, c);
+            break;
+        case node_type::sparse_kind: {
+            auto b = static_cast<sparse_block*>(n->block);
+            insert_sorted(b->keys, b->children, n->count, i, c);
+            break;
+        }
+        case node_type::indexed_kind: {
+            auto b = static_cast<indexed_block*>(n->block);
+            std::size_t slot = 0;
+            while (b->children[slot] != nullptr) ++slot;
+            b->children[slot] = c;
+            b->index[i] = static_cast<std::uint8_t>(slot + 1);
+            break;
+        }
+        default:
+            static_cast<dense_block*>(n->block)->children[i] = c;
+        }
+        n->count++;
+    }
+
+    template <typename Allocator>
+    static void detach(Allocator& alloc, node_type* n, std::size_t i) {
+        switch (n->kind) {
+        case node_type::inline_kind:
+            erase_sorted(n->keys, n->children, n->count, i);
+            break;
+        case node_type::sparse_kind: {
+            auto b = static_cast<sparse_block*>(n->block);
+            erase_sorted(b->keys, b->children, n->count, i);
+            break;
+        }
+        case node_type::indexed_kind: {
+            auto b = static_cast<indexed_block*>(n->block);
+            b->children[b->index[i] - 1] = nullptr;
+            b->index[i] = 0;
+            break;
+        }
+        default:
+            static_cast<dense_block*>(n->block)->children[i] = nullptr;
+        }
+        n->count--;
+
+        kind_type k = shrunk_kind(n->kind, n->count);
+        if (k != n->kind) convert(alloc, n, k);
+    }
+
+    // Frees the child block of a node whose children were already destroyed.
+    template <typename Allocator>
+    static void release(Allocator& alloc, node_type* n) {
+        switch (n->kind) {
+        case node_type::inline_kind:  break;
+        case node_type::sparse_kind:  deallocate<sparse_block>(alloc, n->block);  break;
+        case node_type::indexed_kind: deallocate<indexed_block>(alloc, n->block); break;
+        default:                      deallocate<dense_block>(alloc, n->block);
+        }
+        init(n);
+    }
+
+    static void take_children(node_type* dst, node_type* src) {
+        copy_children(dst, src);
+        init(src);
+    }
+
+    static void swap_children(node_type* a, node_type* b) {
+        node_type tmp;
+        copy_children(&tmp, a);
+        copy_children(a, b);
+        copy_children(b, &tmp);
+    }
+
+private:
+    static constexpr std::size_t capacity(kind_type k) {
+        switch (k) {
+        case node_type::inline_kind:  return node_type::inline_capacity;
+        case node_type::sparse_kind:  return node_type::sparse_capacity;
+        case node_type::indexed_kind: return node_type::indexed_capacity;
+        default:                      return R;
+        }
+    }
+
+    static constexpr kind_type grown_kind(kind_type k) {
+        if (k == node_type::inline_kind && node_type::sparse_capacity < R) return node_type::sparse_kind;
+        if (k <= node_type::sparse_kind && node_type::indexed_capacity < R) return node_type::indexed_kind;
+        return node_type::dense_kind;
+    }
+
+    // Shrinking happens well below the capacity of the smaller layout so that a node which
+    // oscillates around a layout boundary is not reallocated on every insert and erase.
+    static constexpr kind_type shrunk_kind(kind_type k, std::size_t count) {
+        if (count <= node_type::inline_capacity - 1) return node_type::inline_kind;
+        if (k > node_type::sparse_kind && count <= node_type::sparse_capacity - 4 &&
+            node_type::sparse_capacity < R) return node_type::sparse_kind;
+        if (k > node_type::indexed_kind && count <= node_type::indexed_capacity - 12 &&
+            node_type::indexed_capacity < R) return node_type::indexed_kind;
+        return k;
+    }
+
+    template <std::size_t N, typename Children>
+    static node_type* find_child(const symbol_type (&keys)[N], const Children& children, std::size_t count,
+                                 std::size_t i) {
+        std::size_t j = find_symbol(keys, count, i);
+        return j == count ? nullptr : children[j];
+    }
+
+    static std::size_t next_sorted(const symbol_type* keys, std::size_t count, std::size_t pos) {
+        for (std::size_t j = 0; j < count; ++j) if (keys[j] >= pos) return keys[j];
+        return R;
+    }
+
+    static std::size_t prev_sorted(const symbol_type* keys, std::size_t count, std::size_t pos) {
+        for (std::size_t j = count; j > 0; --j) if (keys[j - 1] < pos) return keys[j - 1];
+        return R;
+    }
+
+    static void insert_sorted(symbol_type* keys, node_type** children, std::size_t count,
+                              std::size_t i, node_type* c) {
+        std::size_t j = count;
+        for (; j > 0 && keys[j - 1] > i; --j) {
+            keys[j] = keys[j - 1];
+            children[j] = children[j - 1];
+        }
+        keys[j] = static_cast<symbol_type>(i);
+        children[j] = c;
+    }
+
+    static void erase_sorted(symbol_type* keys, node_type** children, std::size_t count, std::size_t i) {
+        std::size_t j = 0;
+        while (keys[j] != i) ++j;
+        for (; j + 1 < count; ++j) {
+            keys[j] = keys[j + 1];
+            children[j] = children[j + 1];
+        }
+        children[count - 1] = nullptr;
+    }
+
+    static void copy_children(node_type* dst, const node_type* src) {
+        dst->count = src->count;
+        dst->kind  = src->kind;
+        std::copy(std::begin(src->keys), std::end(src->keys), std::begin(dst->keys));
+        if (src->kind == node_type::inline_kind)
+            std::copy(std::begin(src->children), std::end(src->children), std::begin(dst->children));
+        else dst->block = src->block;
+    }
+
+    template <typename Block, typename Allocator>
+    static Block* allocate(Allocator& alloc) {
+        using traits = typename std::allocator_traits<Allocator>::template rebind_traits<Block>;
+        typename traits::allocator_type block_alloc(alloc);
+        Block* b = traits::allocate(block_alloc, 1);
+        traits::construct(block_alloc, b);
+        return b;
+    }
+
+    template <typename Block, typename Allocator>
+    static void deallocate(Allocator& alloc, void* p) {
+        using traits = typename std::allocator_traits<Allocator>::template rebind_traits<Block>;
+        typename traits::allocator_type block_alloc(alloc);
+        Block* b = static_cast<Block*>(p);
+        traits::destroy(block_alloc, b);
+        traits::deallocate(block_alloc, b, 1);
+    }
+
+    // Rebuilds the children of n in layout k. Only called with at most 48 children.
+    template <typename Allocator>
+    static void convert(Allocator& alloc, node_type* n, kind_type k) {
+        symbol_type keys[node_type::indexed_capacity];
+        node_type*  children[node_type::indexed_capacity];
+        std::size_t count = 0;
+        for (std::size_t i = next(n, 0); i < R; i = next(n, i + 1)) {
+            keys[count] = static_cast<symbol_type>(i);
+            children[count++] = child(n, i);
+        }
+
+        void* block = nullptr;
+        switch (k) {
+        case node_type::inline_kind: break;
+        case node_type::sparse_kind: {
+            auto b = allocate<sparse_block>(alloc);
+            std::copy(keys, keys + count, b->keys);
+            std::copy(children, children + count, b->children);
+            block = b;
+            break;
+        }
+        case node_type::indexed_kind: {
+            auto b = allocate<indexed_block>(alloc);
+            for (std::size_t j = 0; j < count; ++j) {
+                b->index[keys[j]] = static_cast<std::uint8_t>(j + 1);
+                b->children[j] = children[j];
+            }
+            block = b;
+            break;
+        }
+        default: {
+            auto b = allocate<dense_block>(alloc);
+            for (std::size_t j = 0; j < count; ++j) b->children[keys[j]] = children[j];
+            block = b;
+        }
+        }
+
+        release(alloc, n);
+        n->kind  = k;
+        n->count = static_cast<std::uint32_t>(count);
+        if (k == node_type::inline_kind) {
+            std::copy(keys, keys + count, n->keys);
+            std::copy(children, children + count, n->children);
+        } else n->block = block;
+    }
+};
+
+} // namespace rmr::detail
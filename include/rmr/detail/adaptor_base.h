@@ -9,12 +9,14 @@
 
 #include <algorithm>
 #include <initializer_list>
+#include <limits>
 #include <stdexcept>
 #include <tuple>
 #include <utility>
 
 #include <rmr/meta.h>
 #include <rmr/node_handle.h>
+#include <rmr/options.h>
 
 namespace rmr::detail {
 
@@ -31,6 +33,15 @@ std::enable_if_t<is_detected_v<has_key_compare, Trie>, typename Trie::key_compar
 template <typename Trie>
 using key_func_t = decltype(key_func<Trie>());
 
+template <typename T, typename It, typename Out>
+using has_find_many = decltype(std::declval<const T&>().find_many(
+    std::declval<It>(), std::declval<It>(), std::declval<Out>(),
+    std::declval<typename T::const_iterator (*)(typename T::const_iterator)>()
+));
+
+template <typename T, typename It>
+using has_assign_sorted = decltype(std::declval<T&>().assign_sorted(std::declval<It>(), std::declval<It>()));
+
 template <typename Derived, typename Trie>
 class adaptor_base {
     using derived_type = Derived;
@@ -68,6 +79,14 @@ public:
     adaptor_base(InputIterator first, InputIterator last, allocator_type alloc) :
         adaptor_base(std::move(alloc)) { insert(first, last); }
 
+    template <typename InputIterator>
+    adaptor_base(sorted_input_t, InputIterator first, InputIterator last,
+         key_functor kf = key_functor(), allocator_type alloc = allocator_type()
+    ) : adaptor_base(std::move(kf), std::move(alloc)) { assign_sorted(first, last); }
+    template <typename InputIterator>
+    adaptor_base(sorted_input_t, InputIterator first, InputIterator last, allocator_type alloc) :
+        adaptor_base(std::move(alloc)) { assign_sorted(first, last); }
+
     adaptor_base(const adaptor_base&) = default;
     adaptor_base(const adaptor_base& other, allocator_type alloc) : trie_(other, std::move(alloc)) {}
 
@@ -137,6 +156,18 @@ public:
     void insert(InputIt first, InputIt last) { while (first != last) insert(*(first++)); }
     void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
 
+    // Replaces the contents with [first, last). Tries which support it build input that is already
+    // in iteration order in one pass instead of inserting from the root for every value.
+    template <typename InputIt>
+    void assign_sorted(InputIt first, InputIt last) {
+        if constexpr (is_detected_v<has_assign_sorted, Trie, InputIt>) {
+            trie_.assign_sorted(first, last);
+        } else {
+            clear();
+            insert(first, last);
+        }
+    }
+
     insert_return_type insert(node_type&& nh) {
         insert_return_type ret;
         if (nh.empty()) {
@@ -211,10 +242,42 @@ public:
     const_iterator longest_match(const key_type& k) const
     { return trie_.longest_match(k); }
 
+    // Batched lookups write one result per key in [first, last) to out, in order. Tries which
+    // support it walk groups of keys together so that their cache misses overlap.
+    template <typename ForwardIterator, typename OutputIterator>
+    OutputIterator find_many(ForwardIterator first, ForwardIterator last, OutputIterator out) const
+    { return find_many_with(first, last, out, [](const_iterator it) { return it; }); }
+
+    template <typename ForwardIterator, typename OutputIterator>
+    OutputIterator count_many(ForwardIterator first, ForwardIterator last, OutputIterator out) const {
+        const_iterator e = end();
+        return find_many_with(first, last, out, [e](const_iterator it) { return size_type(it != e); });
+    }
+
+    template <typename ForwardIterator, typename OutputIterator>
+    OutputIterator longest_match_many(ForwardIterator first, ForwardIterator last, OutputIterator out) const {
+        if constexpr (is_detected_v<has_find_many, Trie, ForwardIterator, OutputIterator>) {
+            return trie_.longest_match_many(first, last, out, [](const_iterator it) { return it; });
+        } else {
+            for (; first != last; ++first) *out++ = longest_match(*first);
+            return out;
+        }
+    }
+
 protected:
     Trie trie_;
 
 private:
+    template <typename ForwardIterator, typename OutputIterator, typename F>
+    OutputIterator find_many_with(ForwardIterator first, ForwardIterator last, OutputIterator out, F f) const {
+        if constexpr (is_detected_v<has_find_many, Trie, ForwardIterator, OutputIterator>) {
+            return trie_.find_many(first, last, out, f);
+        } else {
+            for (; first != last; ++first) *out++ = f(find(*first));
+            return out;
+        }
+    }
+
     derived_type& derived() { return static_cast<derived_type&>(*this); }
     const derived_type& derived() const { return static_cast<const derived_type&>(*this); }
 };
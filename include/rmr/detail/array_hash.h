@@ -0,0 +1,263 @@
+// Armor
+//
+// Copyright Ron Mordechai, 2018
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+namespace rmr::detail {
+
+// A cache-conscious array hash: every slot is one contiguous buffer of records, each holding the
+// length of a string, its symbols and a pointer to its value, so a lookup scans a single buffer
+// without following pointers. An index of all records is kept beside the slots and only sorted
+// when sorted order is asked for.
+//
+// Strings are read through a source, a callable returning the symbol at a position. The bucket
+// does not keep an allocator, one is passed to every call that allocates.
+template <typename T, typename Symbol>
+class array_hash_bucket {
+public:
+    static constexpr std::size_t slot_count = 32;
+
+    struct entry {
+        T*            value;
+        std::uint32_t slot;
+        std::uint32_t offset;
+    };
+
+    class record {
+    public:
+        explicit record(const unsigned char* p) : p_(p) {}
+
+        std::size_t size() const { return load<std::uint32_t>(p_); }
+        std::size_t operator[](std::size_t i) const
+        { return load<Symbol>(p_ + sizeof(std::uint32_t) + i * sizeof(Symbol)); }
+        T* value() const { return load<T*>(p_ + sizeof(std::uint32_t) + size() * sizeof(Symbol)); }
+
+        std::size_t bytes() const { return record_size(size()); }
+    private:
+        const unsigned char* p_;
+    };
+
+    static constexpr std::uint64_t hash_seed = 14695981039346656037ull;
+    static std::uint64_t hash_step(std::uint64_t h, std::size_t s) { return (h ^ s) * 1099511628211ull; }
+
+    template <typename Source>
+    static std::uint64_t hash(Source src, std::size_t n) {
+        std::uint64_t h = hash_seed;
+        for (std::size_t i = 0; i < n; ++i) h = hash_step(h, src(i));
+        return h;
+    }
+
+    array_hash_bucket() = default;
+    array_hash_bucket(const array_hash_bucket&) = delete;
+    array_hash_bucket& operator=(const array_hash_bucket&) = delete;
+
+    std::size_t size() const { return size_; }
+
+    template <typename Source>
+    T* find(Source src, std::size_t n) const { return find(hash(src, n), src, n); }
+
+    template <typename Source>
+    T* find(std::uint64_t h, Source src, std::size_t n) const {
+        const slot_type& s = slots_[slot_of(h)];
+        for (std::uint32_t offset = 0; offset < s.size;) {
+            record r(s.data + offset);
+            if (matches(r, src, n)) return r.value();
+            offset += static_cast<std::uint32_t>(r.bytes());
+        }
+        return nullptr;
+    }
+
+    // Appends a string which is not in the bucket yet.
+    template <typename Allocator, typename Source>
+    void insert(Allocator& alloc, Source src, std::size_t n, T* v) {
+        std::uint32_t i = static_cast<std::uint32_t>(slot_of(hash(src, n)));
+        slot_type& s = slots_[i];
+        std::size_t bytes = record_size(n);
+        if (s.size + bytes > s.capacity) grow(alloc, s, s.size + bytes);
+        if (size_ == entries_capacity_) grow_entries(alloc);
+
+        unsigned char* p = s.data + s.size;
+        store(p, static_cast<std::uint32_t>(n));
+        for (std::size_t j = 0; j < n; ++j)
+            store(p + sizeof(std::uint32_t) + j * sizeof(Symbol), static_cast<Symbol>(src(j)));
+        store(p + sizeof(std::uint32_t) + n * sizeof(Symbol), v);
+
+        entries_[size_++] = { v, i, s.size };
+        s.size += static_cast<std::uint32_t>(bytes);
+        sorted_ = false;
+    }
+
+    // Removes the record of v, hint is where v is expected in the index. The index stays sorted.
+    template <typename Allocator>
+    T* erase(Allocator&, std::size_t hint, const T* v) {
+        std::size_t i = locate(hint, v);
+        entry e = entries_[i];
+        slot_type& s = slots_[e.slot];
+        std::uint32_t bytes = static_cast<std::uint32_t>(record(s.data + e.offset).bytes());
+
+        std::memmove(s.data + e.offset, s.data + e.offset + bytes, s.size - e.offset - bytes);
+        s.size -= bytes;
+        std::move(entries_ + i + 1, entries_ + size_, entries_ + i);
+        size_--;
+        for (std::size_t j = 0; j < size_; ++j)
+            if (entries_[j].slot == e.slot && entries_[j].offset > e.offset) entries_[j].offset -= bytes;
+        return e.value;
+    }
+
+    // The index entry of v, trying hint and the entry before it first.
+    std::size_t locate(std::size_t hint, const T* v) const {
+        if (hint < size_ && entries_[hint].value == v) return hint;
+        if (hint > 0 && hint - 1 < size_ && entries_[hint - 1].value == v) return hint - 1;
+        std::size_t i = 0;
+        while (entries_[i].value != v) ++i;
+        return i;
+    }
+
+    const entry* sorted() const {
+        if (!sorted_) {
+            std::sort(entries_, entries_ + size_, [this](const entry& a, const entry& b) {
+                return compare(record_of(a), [&](std::size_t i) { return record_of(b)[i]; }, record_of(b).size()) < 0;
+            });
+            sorted_ = true;
+        }
+        return entries_;
+    }
+
+    // The range of sorted entries starting with the string read from src.
+    template <typename Source>
+    std::pair<std::size_t, std::size_t> prefixed_with(Source src, std::size_t n) const {
+        const entry* first = sorted();
+        const entry* last  = first + size_;
+        const entry* lo = std::partition_point(first, last,
+            [&](const entry& e) { return compare(record_of(e), src, n) < 0; }
+        );
+        const entry* hi = std::partition_point(lo, last,
+            [&](const entry& e) { return has_prefix(record_of(e), src, n); }
+        );
+        return { lo - first, hi - first };
+    }
+
+    template <typename F>
+    void for_each(F f) const {
+        for (const slot_type& s : slots_) {
+            for (std::uint32_t offset = 0; offset < s.size;) {
+                record r(s.data + offset);
+                f(r);
+                offset += static_cast<std::uint32_t>(r.bytes());
+            }
+        }
+    }
+
+    template <typename Allocator>
+    void release(Allocator& alloc) {
+        byte_allocator<Allocator> bytes(alloc);
+        for (slot_type& s : slots_) {
+            if (s.data != nullptr) std::allocator_traits<byte_allocator<Allocator>>::deallocate(bytes, s.data, s.capacity);
+            s = slot_type();
+        }
+        entry_allocator<Allocator> entries(alloc);
+        if (entries_ != nullptr)
+            std::allocator_traits<entry_allocator<Allocator>>::deallocate(entries, entries_, entries_capacity_);
+        entries_ = nullptr;
+        entries_capacity_ = 0;
+        size_ = 0;
+    }
+
+private:
+    struct slot_type {
+        unsigned char* data     = nullptr;
+        std::uint32_t  size     = 0;
+        std::uint32_t  capacity = 0;
+    };
+
+    template <typename Allocator>
+    using byte_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<unsigned char>;
+    template <typename Allocator>
+    using entry_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<entry>;
+
+    template <typename U>
+    static U load(const unsigned char* p) {
+        U u;
+        std::memcpy(&u, p, sizeof(U));
+        return u;
+    }
+
+    template <typename U>
+    static void store(unsigned char* p, U u) { std::memcpy(p, &u, sizeof(U)); }
+
+    static constexpr std::size_t record_size(std::size_t n)
+    { return sizeof(std::uint32_t) + n * sizeof(Symbol) + sizeof(T*); }
+
+    static std::size_t slot_of(std::uint64_t h) { return (h ^ (h >> 32)) & (slot_count - 1); }
+
+    record record_of(const entry& e) const { return record(slots_[e.slot].data + e.offset); }
+
+    template <typename Source>
+    static bool matches(const record& r, Source src, std::size_t n) {
+        if (r.size() != n) return false;
+        for (std::size_t i = 0; i < n; ++i) if (r[i] != src(i)) return false;
+        return true;
+    }
+
+    template <typename Source>
+    static bool has_prefix(const record& r, Source src, std::size_t n) {
+        if (r.size() < n) return false;
+        for (std::size_t i = 0; i < n; ++i) if (r[i] != src(i)) return false;
+        return true;
+    }
+
+    // Lexicographic comparison of a record and a string, a proper prefix orders first.
+    template <typename Source>
+    static int compare(const record& r, Source src, std::size_t n) {
+        std::size_t m = std::min(r.size(), n);
+        for (std::size_t i = 0; i < m; ++i) {
+            std::size_t a = r[i], b = src(i);
+            if (a != b) return a < b ? -1 : 1;
+        }
+        if (r.size() == n) return 0;
+        return r.size() < n ? -1 : 1;
+    }
+
+    template <typename Allocator>
+    static void grow(Allocator& alloc, slot_type& s, std::size_t n) {
+        byte_allocator<Allocator> bytes(alloc);
+        std::size_t capacity = std::max<std::size_t>(n, s.capacity * 2);
+        unsigned char* data = std::allocator_traits<byte_allocator<Allocator>>::allocate(bytes, capacity);
+        if (s.data != nullptr) {
+            std::memcpy(data, s.data, s.size);
+            std::allocator_traits<byte_allocator<Allocator>>::deallocate(bytes, s.data, s.capacity);
+        }
+        s.data = data;
+        s.capacity = static_cast<std::uint32_t>(capacity);
+    }
+
+    template <typename Allocator>
+    void grow_entries(Allocator& alloc) {
+        entry_allocator<Allocator> entries(alloc);
+        std::size_t capacity = entries_capacity_ == 0 ? 4 : entries_capacity_ * 2;
+        entry* data = std::allocator_traits<entry_allocator<Allocator>>::allocate(entries, capacity);
+        std::copy(entries_, entries_ + size_, data);
+        if (entries_ != nullptr)
+            std::allocator_traits<entry_allocator<Allocator>>::deallocate(entries, entries_, entries_capacity_);
+        entries_ = data;
+        entries_capacity_ = capacity;
+    }
+
+    slot_type      slots_[slot_count];
+    entry*         entries_          = nullptr;
+    std::size_t    entries_capacity_ = 0;
+    std::size_t    size_             = 0;
+    mutable bool   sorted_           = true;
+};
+
+} // namespace rmr::detail
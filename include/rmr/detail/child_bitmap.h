@@ -0,0 +1,97 @@
+// Armor
+//
+// Copyright Ron Mordechai, 2018
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+
+namespace rmr::detail {
+
+inline std::size_t count_trailing_zeros(std::uint64_t w) {
+#if defined(__GNUC__)
+    return static_cast<std::size_t>(__builtin_ctzll(w));
+#else
+    std::size_t n = 0;
+    while ((w & 1) == 0) { w >>= 1; ++n; }
+    return n;
+#endif
+}
+
+inline std::size_t count_leading_zeros(std::uint64_t w) {
+#if defined(__GNUC__)
+    return static_cast<std::size_t>(__builtin_clzll(w));
+#else
+    std::size_t n = 0;
+    while ((w & (std::uint64_t(1) << 63)) == 0) { w <<= 1; ++n; }
+    return n;
+#endif
+}
+
+inline std::size_t count_ones(std::uint64_t w) {
+#if defined(__GNUC__)
+    return static_cast<std::size_t>(__builtin_popcountll(w));
+#else
+    std::size_t n = 0;
+    for (; w != 0; w &= w - 1) ++n;
+    return n;
+#endif
+}
+
+// One bit for every child slot of a node, set when the slot is occupied. Finding the next or
+// previous child and counting children reads a word at a time instead of a pointer at a time.
+template <std::size_t R>
+struct child_bitmap {
+    static constexpr std::size_t words = (R + 63) / 64;
+
+    std::uint64_t bits[words];
+
+    void clear() { std::fill(std::begin(bits), std::end(bits), 0); }
+
+    void set(std::size_t i)   { bits[i / 64] |=  bit(i); }
+    void reset(std::size_t i) { bits[i / 64] &= ~bit(i); }
+
+    // The first occupied slot at or after pos, or R.
+    std::size_t next(std::size_t pos) const {
+        if (pos >= R) return R;
+
+        std::size_t w = pos / 64;
+        std::uint64_t word = bits[w] & (~std::uint64_t(0) << (pos % 64));
+        while (word == 0) {
+            if (++w == words) return R;
+            word = bits[w];
+        }
+        return w * 64 + count_trailing_zeros(word);
+    }
+
+    // The last occupied slot before pos, or R.
+    std::size_t prev(std::size_t pos) const {
+        if (pos == 0) return R;
+
+        std::size_t w = (pos - 1) / 64;
+        std::uint64_t word = bits[w] & (~std::uint64_t(0) >> (63 - (pos - 1) % 64));
+        while (word == 0) {
+            if (w-- == 0) return R;
+            word = bits[w];
+        }
+        return w * 64 + 63 - count_leading_zeros(word);
+    }
+
+    std::size_t count() const {
+        std::size_t c = 0;
+        for (std::uint64_t word : bits) c += count_ones(word);
+        return c;
+    }
+
+    void swap(child_bitmap& other) { std::swap_ranges(std::begin(bits), std::end(bits), std::begin(other.bits)); }
+
+private:
+    static std::uint64_t bit(std::size_t i) { return std::uint64_t(1) << (i % 64); }
+};
+
+} // namespace rmr::detail
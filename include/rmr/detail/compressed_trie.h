@@ -0,0 +1,517 @@
+// Armor
+//
+// Copyright Ron Mordechai, 2018
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <algorithm>
+#include <memory>
+
+#include <rmr/detail/symbol_search.h>
+#include <rmr/detail/trie.h>
+#include <rmr/detail/trie_node_base.h>
+#include <rmr/detail/util.h>
+#include <rmr/options.h>
+
+namespace rmr::detail {
+
+// The characters of the edge leading into a compressed trie node. Short labels are stored in the
+// node itself, longer ones in a buffer from the container's allocator.
+template <typename Char>
+struct compressed_trie_label {
+    static constexpr std::size_t inline_capacity = std::max<std::size_t>(16 / sizeof(Char), 1);
+
+    std::size_t size;
+    union {
+        Char  inline_chars[inline_capacity];
+        Char* chars;
+    };
+
+    const Char* data() const { return size <= inline_capacity ? inline_chars : chars; }
+
+    // Sets the label to a followed by b. Either may point into the current label.
+    template <typename Allocator>
+    void assign(Allocator& alloc, const Char* a, std::size_t na, const Char* b = nullptr, std::size_t nb = 0) {
+        using traits = typename std::allocator_traits<Allocator>::template rebind_traits<Char>;
+        typename traits::allocator_type char_alloc(alloc);
+
+        std::size_t n = na + nb;
+        if (n <= inline_capacity) {
+            Char buf[inline_capacity];
+            std::copy(a, a + na, buf);
+            std::copy(b, b + nb, buf + na);
+            release(alloc);
+            std::copy(buf, buf + n, inline_chars);
+        } else {
+            Char* p = traits::allocate(char_alloc, n);
+            std::copy(a, a + na, p);
+            std::copy(b, b + nb, p + na);
+            release(alloc);
+            chars = p;
+        }
+        size = n;
+    }
+
+    template <typename Allocator>
+    void release(Allocator& alloc) {
+        using traits = typename std::allocator_traits<Allocator>::template rebind_traits<Char>;
+        typename traits::allocator_type char_alloc(alloc);
+
+        if (size > inline_capacity) traits::deallocate(char_alloc, chars, size);
+        size = 0;
+    }
+};
+
+// A trie node which stands for a whole run of single child edges. The first character of its
+// label maps to parent_index.
+template <typename T, typename Char, std::size_t R>
+struct compressed_trie_node : trie_node_base<compressed_trie_node<T, Char, R>, T, R> {
+    std::size_t parent_index;
+    child_bitmap<R> occupied;
+    compressed_trie_label<Char> label;
+};
+
+template <
+    typename T, std::size_t R, typename KeyMapper, typename Key, typename Allocator, typename... Options
+>
+class compressed_trie {
+    using alloc_traits        = std::allocator_traits<Allocator>;
+    using node_type           = compressed_trie_node<T, typename Key::value_type, R>;
+    using layout_type         = dense_layout<node_type, R>;
+    using node_allocator_type = typename alloc_traits::template rebind_alloc<node_type>;
+    using node_alloc_traits   = typename alloc_traits::template rebind_traits<node_type>;
+    using node_pointer        = typename node_alloc_traits::pointer;
+    using node_const_pointer  = typename node_alloc_traits::const_pointer;
+    using node_storage_type   = node_storage_t<node_type, Options...>;
+
+    using iterator_traits       = trie_iterator_traits<layout_type, node_pointer>;
+    using const_iterator_traits = trie_iterator_traits<layout_type, node_const_pointer>;
+
+    static_assert(
+        std::is_same_v<find_option_t<node_layout_option, dense_nodes, Options...>, dense_nodes>,
+        "Compressed tries only support dense nodes"
+    );
+public:
+    using key_type               = Key;
+    using char_type              = typename key_type::value_type;
+    using value_type             = T;
+    using size_type              = std::size_t;
+    using difference_type        = std::ptrdiff_t;
+    using key_mapper             = KeyMapper;
+    using allocator_type         = Allocator;
+    using reference              = value_type&;
+    using const_reference        = const value_type&;
+    using pointer                = typename alloc_traits::pointer;
+    using const_pointer          = typename alloc_traits::const_pointer;
+    using iterator               = trie_iterator<iterator_traits>;
+    using const_iterator         = trie_iterator<const_iterator_traits>;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    compressed_trie() = default;
+    explicit compressed_trie(allocator_type alloc) : impl_(node_allocator_type(std::move(alloc))) {}
+    explicit compressed_trie(key_mapper km, allocator_type alloc) :
+        impl_(std::move(km), node_allocator_type(std::move(alloc)))
+    {}
+
+    compressed_trie(const compressed_trie& other) : compressed_trie(
+        other.key_map(),
+        alloc_traits::select_on_container_copy_construction(other.get_allocator())
+    ) {
+        copy_nodes(&other.impl_.root, &impl_.root, nullptr);
+        impl_.size = other.impl_.size;
+    }
+    compressed_trie(const compressed_trie& other, allocator_type alloc) :
+        compressed_trie(other.key_map(), std::move(alloc))
+    {
+        copy_nodes(&other.impl_.root, &impl_.root, nullptr);
+        impl_.size = other.impl_.size;
+    }
+
+    compressed_trie(compressed_trie&& other) :
+        compressed_trie(std::move(other.key_map()), std::move(other.get_allocator()))
+    {
+        static_cast<compressed_trie_header&>(impl_) =
+            std::move(static_cast<compressed_trie_header&>(other.impl_));
+    }
+    compressed_trie(compressed_trie&& other, allocator_type alloc) :
+        compressed_trie(std::move(other.key_map()), std::move(alloc))
+    {
+        if (alloc != other.get_allocator()) {
+            auto other_alloc = other.get_allocator();
+            move_nodes(other_alloc, &other.impl_.root, &impl_.root, nullptr);
+            impl_.size = other.impl_.size;
+            other.clear();
+        } else {
+            static_cast<compressed_trie_header&>(impl_) =
+                std::move(static_cast<compressed_trie_header&>(other.impl_));
+        }
+    }
+    ~compressed_trie() { clear(); }
+
+    compressed_trie& operator=(const compressed_trie& other) {
+        clear();
+        impl_.size = other.impl_.size;
+        static_cast<key_mapper&>(impl_) = other.key_map();
+        if (alloc_traits::propagate_on_container_copy_assignment::value) {
+            static_cast<node_allocator_type&>(impl_) = other.get_node_allocator();
+        }
+        copy_nodes(&other.impl_.root, &impl_.root, nullptr);
+        return *this;
+    }
+
+    compressed_trie& operator=(compressed_trie&& other) noexcept(
+        alloc_traits::is_always_equal::value && std::is_nothrow_move_assignable<key_mapper>::value
+    ) {
+        clear();
+        static_cast<key_mapper&>(impl_) = other.key_map();
+        if (alloc_traits::propagate_on_container_move_assignment::value)
+            static_cast<node_allocator_type&>(impl_) = other.get_node_allocator();
+
+        auto other_alloc = other.get_allocator();
+        if (!alloc_traits::propagate_on_container_move_assignment::value &&
+                get_allocator() != other.get_allocator()) {
+            move_nodes(other_alloc, &other.impl_.root, &impl_.root, nullptr);
+            impl_.size = other.impl_.size;
+        } else {
+            static_cast<compressed_trie_header&>(impl_) =
+                std::move(static_cast<compressed_trie_header&>(other.impl_));
+        }
+
+        other.clear();
+        return *this;
+    }
+
+    void swap(compressed_trie& other) noexcept(
+        alloc_traits::is_always_equal::value && std::is_nothrow_swappable<key_mapper>::value
+    ) {
+        if (alloc_traits::propagate_on_container_swap::value) {
+            node_allocator_type& this_alloc = impl_;
+            static_cast<node_allocator_type&>(impl_) = other.get_node_allocator();
+            other.get_node_allocator() = this_alloc;
+        }
+        key_mapper this_key_map = key_map();
+        static_cast<key_mapper&>(impl_) = other.key_map();
+        static_cast<key_mapper&>(other.impl_) = this_key_map;
+        layout_type::swap_children(&impl_.root, &other.impl_.root);
+        adopt_children(&impl_.root);
+        adopt_children(&other.impl_.root);
+        std::swap(impl_.root.value, other.impl_.root.value);
+        std::swap(impl_.size, other.impl_.size);
+        impl_.nodes.swap(other.impl_.nodes);
+    }
+
+    // Hints are not used, every insertion walks down from the root.
+    template <typename... Args>
+    iterator emplace(const_iterator, const key_type& key, Args&&... args)
+    { return insert_node(key, make_value(get_allocator(), std::forward<Args>(args)...)); }
+
+    iterator reinsert(const_iterator, const key_type& key, const_pointer p)
+    { return insert_node(key, const_cast<pointer>(p)); }
+
+    iterator find(const key_type& key)
+    { return remove_const(const_cast<const compressed_trie&>(*this).find(key)); }
+    const_iterator find(const key_type& key) const { return find_key(key); }
+
+    iterator erase(const_iterator pos) { return erase(remove_const(pos)); }
+    iterator erase(iterator pos) {
+        iterator next = std::next(pos);
+        auto value_alloc = get_allocator();
+        delete_node_value(pos.node, value_alloc);
+        compact(pos.node);
+        impl_.size--;
+        return next;
+    }
+
+    pointer extract(const_iterator pos) {
+        node_pointer node = remove_const(pos).node;
+        pointer v(std::move(node->value));
+        node->value = nullptr;
+        compact(node);
+        impl_.size--;
+        return v;
+    }
+
+    iterator longest_match(const key_type& key)
+    { return remove_const(const_cast<const compressed_trie&>(*this).longest_match(key)); }
+    const_iterator longest_match(const key_type& key) const { return longest_match(&impl_.root, key); }
+
+    std::pair<iterator, iterator> prefixed_with(const key_type& key) {
+        auto p = const_cast<const compressed_trie&>(*this).prefixed_with(key);
+        return { remove_const(p.first), remove_const(p.second) };
+    }
+    std::pair<const_iterator, const_iterator>
+    prefixed_with(const key_type& key) const {
+        const_iterator first = find_prefix(key);
+        if (first == end()) return { end(), end() };
+        const_iterator last(const_iterator_traits::skip(first.node));
+
+        if (                first.node->value == nullptr) ++first;
+        if (last != end() && last.node->value == nullptr) ++last;
+        return {first, last};
+    }
+
+    iterator root() noexcept { return remove_const(croot()); }
+    const_iterator root() const noexcept { return croot(); }
+    const_iterator croot() const noexcept { return &impl_.root; }
+
+    iterator begin() noexcept { return remove_const(cbegin()); }
+    const_iterator begin() const noexcept { return cbegin(); }
+    const_iterator cbegin() const noexcept { return ++const_iterator(&impl_.base); }
+
+    iterator end() noexcept { return remove_const(cend()); }
+    const_iterator end() const noexcept { return cend(); }
+    const_iterator cend() const noexcept { return &impl_.base; }
+
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(cend()); }
+
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crend() const noexcept { return const_reverse_iterator(cbegin()); }
+
+    size_type size() const noexcept { return impl_.size; }
+
+    void clear() noexcept {
+        auto value_alloc = get_allocator();
+        clear_node(&impl_.root, value_alloc);
+        impl_.nodes.release(get_node_allocator());
+        impl_.size = 0;
+    }
+
+    allocator_type get_allocator() const { return get_node_allocator(); }
+    key_mapper     key_map()       const { return impl_; }
+
+private:
+    node_pointer copy_nodes(node_const_pointer src, node_pointer dst, node_pointer parent) {
+        if (dst == nullptr) dst = make_node(parent, src->parent_index, src->label.data(), src->label.size);
+
+        if (src->value != nullptr) dst->value = make_value(get_allocator(), *src->value);
+        for (size_type i = layout_type::next(src, 0); i < R; i = layout_type::next(src, i + 1)) {
+            node_pointer child = copy_nodes(layout_type::child(src, i), layout_type::child(dst, i), dst);
+            layout_type::attach(get_node_allocator(), dst, i, child);
+        }
+        return dst;
+    }
+
+    node_pointer move_nodes(allocator_type& alloc, node_pointer src, node_pointer dst, node_pointer parent) {
+        if (dst == nullptr) dst = make_node(parent, src->parent_index, src->label.data(), src->label.size);
+
+        if (src->value != nullptr) {
+            dst->value = make_value(get_allocator(), std::move(*src->value));
+            destroy_and_deallocate(alloc, src->value);
+            src->value = nullptr;
+        }
+        for (size_type i = layout_type::next(src, 0); i < R; i = layout_type::next(src, i + 1)) {
+            node_pointer child = move_nodes(alloc, layout_type::child(src, i), layout_type::child(dst, i), dst);
+            layout_type::attach(get_node_allocator(), dst, i, child);
+        }
+        return dst;
+    }
+
+    node_pointer insert_node(const key_type& key, pointer v) {
+        const char_type* s = key.data();
+        size_type i = 0, n = key.size();
+
+        node_pointer cur = &impl_.root;
+        while (i != n) {
+            size_type index = key_map()(s[i]);
+            node_pointer child = cur->children[index];
+            if (child == nullptr) {
+                child = make_node(cur, index, s + i, n - i);
+                layout_type::attach(get_node_allocator(), cur, index, child);
+                return set_value(child, v);
+            }
+
+            size_type m = common_prefix(child->label.data(), s + i, std::min(child->label.size, n - i));
+            if (m < child->label.size) child = split(child, m);
+            cur = child;
+            i += m;
+        }
+        return set_value(cur, v);
+    }
+
+    node_pointer set_value(node_pointer n, pointer v) {
+        if (n->value == nullptr) { n->value = v; ++impl_.size; }
+        else                     destroy_and_deallocate(get_allocator(), v);
+        return n;
+    }
+
+    // Cuts the label of n after m characters, putting a new node in its place.
+    node_pointer split(node_pointer n, size_type m) {
+        node_pointer parent = n->parent;
+        node_pointer head = make_node(parent, n->parent_index, n->label.data(), m);
+        layout_type::attach(get_node_allocator(), parent, n->parent_index, head);
+
+        size_type index = key_map()(n->label.data()[m]);
+        n->label.assign(get_node_allocator(), n->label.data() + m, n->label.size - m);
+        n->parent = head;
+        n->parent_index = index;
+        layout_type::attach(get_node_allocator(), head, index, n);
+        return head;
+    }
+
+    // Restores path compression after n lost its value: an empty leaf is removed and an empty
+    // node with a single child is merged into that child.
+    void compact(node_pointer n) {
+        if (n == &impl_.root || n->value != nullptr) return;
+
+        size_type children = layout_type::count(n);
+        if (children == 0) {
+            node_pointer parent = n->parent;
+            layout_type::detach(get_node_allocator(), parent, n->parent_index);
+            destroy_node(n);
+            compact(parent);
+        } else if (children == 1) {
+            node_pointer child = layout_type::child(n, layout_type::next(n, 0));
+            child->label.assign(
+                get_node_allocator(), n->label.data(), n->label.size, child->label.data(), child->label.size
+            );
+            child->parent = n->parent;
+            child->parent_index = n->parent_index;
+            layout_type::attach(get_node_allocator(), n->parent, n->parent_index, child);
+            destroy_node(n);
+        }
+    }
+
+    const auto& get_node_allocator() const { return impl_; }
+          auto& get_node_allocator()       { return impl_; }
+
+    node_pointer make_node(node_pointer parent, size_type parent_index, const char_type* label, size_type n) {
+        node_pointer node = impl_.nodes.create(get_node_allocator());
+
+        layout_type::init(node);
+        node->parent = parent;
+        node->parent_index = parent_index;
+        node->value = nullptr;
+        node->label.size = 0;
+        node->label.assign(get_node_allocator(), label, n);
+
+        return node;
+    }
+
+    void destroy_node(node_pointer n) {
+        n->label.release(get_node_allocator());
+        impl_.nodes.destroy(get_node_allocator(), n);
+    }
+
+    template <typename ValueAllocator>
+    void clear_node(node_pointer n, ValueAllocator& va) {
+        delete_node_value(n, va);
+
+        for (size_type i = layout_type::next(n, 0); i < R; i = layout_type::next(n, i + 1)) {
+            node_pointer child = layout_type::child(n, i);
+            clear_node(child, va);
+            destroy_node(child);
+        }
+        layout_type::release(get_node_allocator(), n);
+    }
+
+    static void adopt_children(node_pointer n) {
+        for (size_type i = layout_type::next(n, 0); i < R; i = layout_type::next(n, i + 1))
+            layout_type::child(n, i)->parent = n;
+    }
+
+    node_const_pointer find_key(const key_type& key) const {
+        const char_type* s = key.data();
+        size_type i = 0, n = key.size();
+
+        node_const_pointer cur = &impl_.root;
+        while (i != n) {
+            cur = cur->children[key_map()(s[i])];
+            if (cur == nullptr || cur->label.size > n - i) return &impl_.base;
+            if (common_prefix(cur->label.data(), s + i, cur->label.size) != cur->label.size) return &impl_.base;
+            i += cur->label.size;
+        }
+        return cur->value == nullptr ? &impl_.base : cur;
+    }
+
+    // The node whose subtree holds exactly the keys starting with key. The key may end in the
+    // middle of the node's label.
+    node_const_pointer find_prefix(const key_type& key) const {
+        const char_type* s = key.data();
+        size_type i = 0, n = key.size();
+
+        node_const_pointer cur = &impl_.root;
+        while (i != n) {
+            cur = cur->children[key_map()(s[i])];
+            if (cur == nullptr) return &impl_.base;
+
+            size_type m = common_prefix(cur->label.data(), s + i, std::min(cur->label.size, n - i));
+            if (m == n - i) return cur;
+            if (m < cur->label.size) return &impl_.base;
+            i += m;
+        }
+        return cur;
+    }
+
+    node_const_pointer longest_match(node_const_pointer root, const key_type& key) const {
+        const char_type* s = key.data();
+        size_type i = 0, n = key.size();
+
+        node_const_pointer cur  = root;
+        node_const_pointer best = &impl_.base;
+        while (true) {
+            if (cur->value != nullptr) best = cur;
+            if (i == n) return best;
+
+            cur = cur->children[key_map()(s[i])];
+            if (cur == nullptr || cur->label.size > n - i) return best;
+            if (common_prefix(cur->label.data(), s + i, cur->label.size) != cur->label.size) return best;
+            i += cur->label.size;
+        }
+    }
+
+    struct compressed_trie_header {
+        node_type base;
+        node_type root;
+        size_type size;
+        node_storage_type nodes;
+
+        compressed_trie_header() { reset(); }
+        compressed_trie_header& operator=(compressed_trie_header&& other) {
+            layout_type::take_children(&root, &other.root);
+            adopt_children(&root);
+            root.value = other.root.value;
+            size = other.size;
+            nodes = std::move(other.nodes);
+            other.reset();
+            return *this;
+        }
+
+        void reset() {
+            layout_type::init_base(&base, &root);
+            base.parent = nullptr;
+            base.parent_index = R;
+            base.value = nullptr;
+            base.label.size = 0;
+
+            layout_type::init(&root);
+            root.parent = &base;
+            root.parent_index = 0;
+            root.value = nullptr;
+            root.label.size = 0;
+
+            size = 0;
+        }
+    };
+
+    struct compressed_trie_impl : compressed_trie_header, key_mapper, node_allocator_type {
+        compressed_trie_impl() = default;
+        compressed_trie_impl(node_allocator_type alloc) :
+            compressed_trie_header(), key_mapper(), node_allocator_type(std::move(alloc))
+        {}
+        compressed_trie_impl(key_mapper km, node_allocator_type alloc) :
+            compressed_trie_header(), key_mapper(std::move(km)), node_allocator_type(std::move(alloc))
+        {}
+        compressed_trie_impl& operator=(compressed_trie_impl&&) = default;
+    };
+
+    compressed_trie_impl impl_;
+};
+
+} // namespace rmr::detail
@@ -0,0 +1,197 @@
+// Armor
+//
+// Copyright Ron Mordechai, 2018
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <rmr/detail/util.h>
+
+namespace rmr::detail {
+
+// A read-only trie in the double-array layout. The children of state s live at base[s] + c for
+// every symbol c they are reached by, and check names the parent of every state, so a transition
+// is two array reads. Values are kept in trie order, which lets every state record the range of
+// values below it.
+template <typename T, std::size_t R, typename KeyMapper, typename Key, typename Allocator>
+class double_array_trie {
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+    struct state {
+        std::uint32_t base;  // 0 for states without children
+        std::uint32_t check; // the parent state, or free
+        std::uint32_t first; // values below the state, its own value comes first
+        std::uint32_t last;
+    };
+
+    using state_allocator_type = typename alloc_traits::template rebind_alloc<state>;
+
+    static constexpr std::uint32_t free_state = std::numeric_limits<std::uint32_t>::max();
+public:
+    using key_type               = Key;
+    using char_type              = typename key_type::value_type;
+    using value_type             = T;
+    using size_type              = std::size_t;
+    using difference_type        = std::ptrdiff_t;
+    using key_mapper             = KeyMapper;
+    using allocator_type         = Allocator;
+    using reference              = const value_type&;
+    using const_reference        = const value_type&;
+    using pointer                = const value_type*;
+    using const_pointer          = const value_type*;
+    using iterator               = const value_type*;
+    using const_iterator         = const value_type*;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    double_array_trie() : double_array_trie(key_mapper()) {}
+    explicit double_array_trie(key_mapper km, allocator_type alloc = allocator_type()) :
+        km_(std::move(km)), values_(alloc), states_(state_allocator_type(alloc))
+    {
+        states_.push_back({ 0, 0, 0, 0 });
+    }
+
+    // Builds the trie from values which are in the order a trie with the same key mapper
+    // iterates them, without repeated keys.
+    template <typename InputIterator>
+    double_array_trie(
+        InputIterator first, InputIterator last,
+        key_mapper km = key_mapper(), allocator_type alloc = allocator_type()
+    ) : km_(std::move(km)), values_(first, last, alloc), states_(state_allocator_type(alloc)) {
+        states_.push_back({ 0, 0, 0, static_cast<std::uint32_t>(values_.size()) });
+        build(0, 0);
+        while (states_.back().check == free_state) states_.pop_back();
+        states_.shrink_to_fit();
+    }
+
+    const_iterator find(const key_type& key) const {
+        std::uint32_t s = walk(key);
+        if (s == free_state || !accepts(s, key.size())) return end();
+        return begin() + states_[s].first;
+    }
+
+    size_type count(const key_type& key) const { return find(key) != end(); }
+
+    std::pair<const_iterator, const_iterator> prefixed_with(const key_type& key) const {
+        std::uint32_t s = walk(key);
+        if (s == free_state) return { end(), end() };
+        return { begin() + states_[s].first, begin() + states_[s].last };
+    }
+
+    const_iterator longest_match(const key_type& key) const {
+        const_iterator best = end();
+        std::uint32_t s = 0;
+        for (size_type i = 0;; ++i) {
+            if (accepts(s, i)) best = begin() + states_[s].first;
+            if (i == key.size()) return best;
+            s = child(s, key[i]);
+            if (s == free_state) return best;
+        }
+    }
+
+    const_iterator begin() const noexcept { return values_.data(); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator end() const noexcept { return values_.data() + values_.size(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crend() const noexcept { return rend(); }
+
+    bool empty() const noexcept { return values_.empty(); }
+    size_type size() const noexcept { return values_.size(); }
+
+    void swap(double_array_trie& other) noexcept(std::is_nothrow_swappable<key_mapper>::value) {
+        using std::swap;
+        swap(km_, other.km_);
+        values_.swap(other.values_);
+        states_.swap(other.states_);
+    }
+
+    friend void swap(double_array_trie& lhs, double_array_trie& rhs) noexcept(noexcept(lhs.swap(rhs)))
+    { lhs.swap(rhs); }
+
+    allocator_type get_allocator() const { return values_.get_allocator(); }
+    key_mapper     key_map()       const { return km_; }
+
+private:
+    std::uint32_t child(std::uint32_t s, char_type c) const {
+        const state& st = states_[s];
+        if (st.base == 0) return free_state;
+        std::size_t t = st.base + km_(c);
+        if (t >= states_.size() || states_[t].check != s) return free_state;
+        return static_cast<std::uint32_t>(t);
+    }
+
+    std::uint32_t walk(const key_type& key) const {
+        std::uint32_t s = 0;
+        for (size_type i = 0; i < key.size() && s != free_state; ++i) s = child(s, key[i]);
+        return s;
+    }
+
+    // The only key of length depth below a state of that depth is its own, and it comes first.
+    bool accepts(std::uint32_t s, size_type depth) const {
+        const state& st = states_[s];
+        return st.first < st.last && key_of<key_type>(values_[st.first]).size() == depth;
+    }
+
+    const key_type& key_at(std::uint32_t i) const { return key_of<key_type>(values_[i]); }
+
+    void build(std::uint32_t s, size_type depth) {
+        struct edge { std::size_t symbol; std::uint32_t first, last; };
+        std::vector<edge> edges;
+
+        std::uint32_t i = states_[s].first, last = states_[s].last;
+        if (i < last && key_at(i).size() == depth) ++i;
+        while (i < last) {
+            std::size_t c = km_(key_at(i)[depth]);
+            std::uint32_t j = i + 1;
+            while (j < last && km_(key_at(j)[depth]) == c) ++j;
+            edges.push_back({ c, i, j });
+            i = j;
+        }
+        if (edges.empty()) return;
+
+        std::uint32_t base = find_base(edges);
+        states_[s].base = base;
+        for (const edge& e : edges) states_[base + e.symbol] = { 0, s, e.first, e.last };
+        for (const edge& e : edges) build(static_cast<std::uint32_t>(base + e.symbol), depth + 1);
+    }
+
+    // The first base at which every edge lands on a free state, growing the arrays to fit.
+    template <typename Edges>
+    std::uint32_t find_base(const Edges& edges) {
+        while (next_free_ < states_.size() && states_[next_free_].check != free_state) ++next_free_;
+
+        std::size_t lowest = edges.front().symbol;
+        std::size_t base = next_free_ > lowest ? next_free_ - lowest : 1;
+        for (;; ++base) {
+            bool fits = true;
+            for (const auto& e : edges) {
+                std::size_t t = base + e.symbol;
+                if (t < states_.size() && states_[t].check != free_state) { fits = false; break; }
+            }
+            if (fits) break;
+        }
+
+        std::size_t size = base + edges.back().symbol + 1;
+        if (states_.size() < size) states_.resize(size, { 0, free_state, 0, 0 });
+        return static_cast<std::uint32_t>(base);
+    }
+
+    key_mapper                                     km_;
+    std::vector<value_type, allocator_type>        values_;
+    std::vector<state, state_allocator_type>       states_;
+    std::size_t                                    next_free_ = 1;
+};
+
+} // namespace rmr::detail
@@ -0,0 +1,632 @@
+// Armor
+//
+// Copyright Ron Mordechai, 2018
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+
+#include <rmr/detail/array_hash.h>
+#include <rmr/detail/symbol_search.h>
+#include <rmr/detail/trie_node_base.h>
+#include <rmr/detail/util.h>
+#include <rmr/options.h>
+
+namespace rmr::detail {
+
+// Every slot of a node leads either to a child node or to a bucket holding the rest of the keys
+// that continue with that symbol, never both.
+template <typename T, std::size_t R>
+struct hat_trie_node {
+    using value_type  = T;
+    using bucket_type = array_hash_bucket<T, trie_symbol_t<R>>;
+    static constexpr std::size_t radix = R;
+
+    hat_trie_node* children[R];
+    bucket_type*   buckets[R];
+    hat_trie_node* parent;
+    T*             value;
+    std::size_t    parent_index;
+};
+
+// Iterators point at the value of a node, or at a bucket entry in sorted order. Buckets are
+// sorted the first time they are stepped through. index is only a hint, a bucket may reorder its
+// entries when it is sorted or erased from, and the value pointer is what identifies the entry.
+template <typename Node>
+struct hat_trie_iterator {
+    using node_type   = Node;
+    using bucket_type = typename std::remove_pointer_t<node_type>::bucket_type;
+    static constexpr std::size_t radix = std::remove_pointer_t<node_type>::radix;
+
+    using value_type        = typename std::remove_pointer_t<node_type>::value_type;
+    using difference_type   = std::ptrdiff_t;
+    using reference         = value_type&;
+    using pointer           = value_type*;
+    using iterator_category = std::bidirectional_iterator_tag;
+
+    using non_const_node_type = std::add_pointer_t<std::remove_const_t<std::remove_pointer_t<node_type>>>;
+    static constexpr bool is_const = std::is_const_v<std::remove_pointer_t<node_type>>;
+
+    node_type   node;
+    std::size_t slot;
+    std::size_t index;
+    pointer     value;
+
+    hat_trie_iterator(node_type n = nullptr, std::size_t s = radix, std::size_t i = 0, pointer v = nullptr) :
+        node(n), slot(s), index(i), value(v)
+    {}
+    hat_trie_iterator(const hat_trie_iterator&) = default;
+
+    template <bool _Const = is_const, typename = std::enable_if_t<_Const>>
+    hat_trie_iterator(const hat_trie_iterator<non_const_node_type>& other) :
+        node(other.node), slot(other.slot), index(other.index), value(other.value)
+    {}
+
+    hat_trie_iterator& operator=(const hat_trie_iterator&) = default;
+
+    hat_trie_iterator& operator++() {
+        if (value == nullptr) return *this = first_in(node);
+        if (slot == radix) return *this = forward_from(node, 0);
+
+        const bucket_type* b = node->buckets[slot];
+        const auto* entries = b->sorted();
+        std::size_t i = b->locate(index, value);
+        if (i + 1 < b->size()) return *this = { node, slot, i + 1, entries[i + 1].value };
+        return *this = forward_from(node, slot + 1);
+    }
+
+    hat_trie_iterator operator++(int) {
+        hat_trie_iterator tmp = *this;
+        ++(*this);
+        return tmp;
+    }
+
+    hat_trie_iterator& operator--() {
+        if (value == nullptr) return *this = backward_from(node, radix);
+        if (slot == radix) {
+            if (node->parent == nullptr) return *this = node;
+            return *this = backward_from(node->parent, node->parent_index);
+        }
+
+        const bucket_type* b = node->buckets[slot];
+        const auto* entries = b->sorted();
+        std::size_t i = b->locate(index, value);
+        if (i > 0) return *this = { node, slot, i - 1, entries[i - 1].value };
+        return *this = backward_from(node, slot);
+    }
+
+    hat_trie_iterator operator--(int) {
+        hat_trie_iterator tmp = *this;
+        --(*this);
+        return tmp;
+    }
+
+    reference operator*() const { return *value; }
+    pointer  operator->() const { return  value; }
+
+    template <typename _Node>
+    bool operator==(const hat_trie_iterator<_Node>& other) const { return value == other.value; }
+
+    template <typename _Node>
+    bool operator!=(const hat_trie_iterator<_Node>& other) const { return !(*this == other); }
+
+    friend void swap(hat_trie_iterator& lhs, hat_trie_iterator& rhs) { std::swap(lhs, rhs); }
+
+    // The first value in the subtree of n. Subtrees below the root are never empty.
+    static hat_trie_iterator first_in(node_type n) {
+        if (n->value != nullptr) return { n, radix, 0, n->value };
+        return forward_from(n, 0);
+    }
+
+    // The first value in a slot of n from slot c on, or after the subtree of n. The end iterator
+    // is the root without a value.
+    static hat_trie_iterator forward_from(node_type n, std::size_t c) {
+        for (;;) {
+            for (; c < radix; ++c) {
+                if (n->children[c] != nullptr) return first_in(n->children[c]);
+                if (n->buckets[c]  != nullptr) return in_bucket(n, c, 0);
+            }
+            if (n->parent == nullptr) return n;
+            c = n->parent_index + 1;
+            n = n->parent;
+        }
+    }
+
+    // The last value in a slot of n before slot c, or before the subtree of n.
+    static hat_trie_iterator backward_from(node_type n, std::size_t c) {
+        for (;;) {
+            while (c-- > 0) {
+                if (n->children[c] != nullptr) return backward_from(n->children[c], radix);
+                if (n->buckets[c]  != nullptr) return in_bucket(n, c, n->buckets[c]->size() - 1);
+            }
+            if (n->value  != nullptr) return { n, radix, 0, n->value };
+            if (n->parent == nullptr) return n;
+            c = n->parent_index;
+            n = n->parent;
+        }
+    }
+
+    static hat_trie_iterator in_bucket(node_type n, std::size_t c, std::size_t i)
+    { return { n, c, i, n->buckets[c]->sorted()[i].value }; }
+};
+
+template <typename Node>
+auto remove_const(hat_trie_iterator<Node> it) {
+    using non_const_node_type = typename hat_trie_iterator<Node>::non_const_node_type;
+    return hat_trie_iterator<non_const_node_type>(
+        const_cast<non_const_node_type>(it.node), it.slot, it.index, it.value
+    );
+}
+
+// A HAT-trie: a burst trie whose leaves are array hash buckets. Keys are pushed down into a
+// bucket as soon as their path leaves the trie nodes, and a bucket bursts into a trie node once it
+// would hold more than burst_threshold keys. The ordered operations sort a bucket the first time they
+// reach it. Inserting may burst a bucket, which invalidates iterators to its entries.
+template <
+    typename T, std::size_t R, typename KeyMapper, typename Key, typename Allocator, typename... Options
+>
+class hat_trie {
+    using alloc_traits        = std::allocator_traits<Allocator>;
+    using node_type           = hat_trie_node<T, R>;
+    using bucket_type         = typename node_type::bucket_type;
+    using node_allocator_type = typename alloc_traits::template rebind_alloc<node_type>;
+    using node_alloc_traits   = typename alloc_traits::template rebind_traits<node_type>;
+    using bucket_allocator_type = typename alloc_traits::template rebind_alloc<bucket_type>;
+    using bucket_alloc_traits   = typename alloc_traits::template rebind_traits<bucket_type>;
+    using node_pointer        = typename node_alloc_traits::pointer;
+    using node_const_pointer  = typename node_alloc_traits::const_pointer;
+    using node_storage_type   = node_storage_t<node_type, Options...>;
+
+    static_assert(
+        std::is_same_v<find_option_t<node_layout_option, dense_nodes, Options...>, dense_nodes>,
+        "HAT-tries do not support node layouts"
+    );
+
+    static constexpr std::size_t burst_threshold = 256;
+public:
+    using key_type               = Key;
+    using char_type              = typename key_type::value_type;
+    using value_type             = T;
+    using size_type              = std::size_t;
+    using difference_type        = std::ptrdiff_t;
+    using key_mapper             = KeyMapper;
+    using allocator_type         = Allocator;
+    using reference              = value_type&;
+    using const_reference        = const value_type&;
+    using pointer                = typename alloc_traits::pointer;
+    using const_pointer          = typename alloc_traits::const_pointer;
+    using iterator               = hat_trie_iterator<node_pointer>;
+    using const_iterator         = hat_trie_iterator<node_const_pointer>;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    hat_trie() = default;
+    explicit hat_trie(allocator_type alloc) : impl_(node_allocator_type(std::move(alloc))) {}
+    explicit hat_trie(key_mapper km, allocator_type alloc) :
+        impl_(std::move(km), node_allocator_type(std::move(alloc)))
+    {}
+
+    hat_trie(const hat_trie& other) : hat_trie(
+        other.key_map(),
+        alloc_traits::select_on_container_copy_construction(other.get_allocator())
+    ) {
+        copy_tree(other);
+    }
+    hat_trie(const hat_trie& other, allocator_type alloc) :
+        hat_trie(other.key_map(), std::move(alloc))
+    {
+        copy_tree(other);
+    }
+
+    hat_trie(hat_trie&& other) :
+        hat_trie(std::move(other.key_map()), std::move(other.get_allocator()))
+    {
+        static_cast<hat_trie_header&>(impl_) = std::move(static_cast<hat_trie_header&>(other.impl_));
+    }
+    hat_trie(hat_trie&& other, allocator_type alloc) :
+        hat_trie(std::move(other.key_map()), std::move(alloc))
+    {
+        if (alloc != other.get_allocator()) {
+            move_tree(other);
+            other.clear();
+        } else {
+            static_cast<hat_trie_header&>(impl_) = std::move(static_cast<hat_trie_header&>(other.impl_));
+        }
+    }
+    ~hat_trie() { clear(); }
+
+    hat_trie& operator=(const hat_trie& other) {
+        clear();
+        static_cast<key_mapper&>(impl_) = other.key_map();
+        if (alloc_traits::propagate_on_container_copy_assignment::value) {
+            static_cast<node_allocator_type&>(impl_) = other.get_node_allocator();
+        }
+        copy_tree(other);
+        return *this;
+    }
+
+    hat_trie& operator=(hat_trie&& other) noexcept(
+        alloc_traits::is_always_equal::value && std::is_nothrow_move_assignable<key_mapper>::value
+    ) {
+        clear();
+        static_cast<key_mapper&>(impl_) = other.key_map();
+        if (alloc_traits::propagate_on_container_move_assignment::value)
+            static_cast<node_allocator_type&>(impl_) = other.get_node_allocator();
+
+        if (!alloc_traits::propagate_on_container_move_assignment::value &&
+                get_allocator() != other.get_allocator()) {
+            move_tree(other);
+        } else {
+            static_cast<hat_trie_header&>(impl_) = std::move(static_cast<hat_trie_header&>(other.impl_));
+        }
+
+        other.clear();
+        return *this;
+    }
+
+    void swap(hat_trie& other) noexcept(
+        alloc_traits::is_always_equal::value && std::is_nothrow_swappable<key_mapper>::value
+    ) {
+        if (alloc_traits::propagate_on_container_swap::value) {
+            node_allocator_type& this_alloc = impl_;
+            static_cast<node_allocator_type&>(impl_) = other.get_node_allocator();
+            other.get_node_allocator() = this_alloc;
+        }
+        key_mapper this_key_map = key_map();
+        static_cast<key_mapper&>(impl_) = other.key_map();
+        static_cast<key_mapper&>(other.impl_) = this_key_map;
+        std::swap_ranges(
+            std::begin(impl_.root.children), std::end(impl_.root.children), std::begin(other.impl_.root.children)
+        );
+        std::swap_ranges(
+            std::begin(impl_.root.buckets), std::end(impl_.root.buckets), std::begin(other.impl_.root.buckets)
+        );
+        std::swap(impl_.root.value, other.impl_.root.value);
+        impl_.adopt_children();
+        other.impl_.adopt_children();
+        std::swap(impl_.size, other.impl_.size);
+        impl_.nodes.swap(other.impl_.nodes);
+    }
+
+    // Hints are not used, every insertion walks down from the root.
+    template <typename... Args>
+    iterator emplace(const_iterator, const key_type& key, Args&&... args)
+    { return insert_value(key, make_value(get_allocator(), std::forward<Args>(args)...)); }
+
+    iterator reinsert(const_iterator, const key_type& key, const_pointer p)
+    { return insert_value(key, const_cast<pointer>(p)); }
+
+    iterator find(const key_type& key)
+    { return remove_const(const_cast<const hat_trie&>(*this).find(key)); }
+    const_iterator find(const key_type& key) const {
+        node_const_pointer n = &impl_.root;
+        for (size_type i = 0;; ++i) {
+            if (i == key.size()) return n->value == nullptr ? end() : const_iterator(n, R, 0, n->value);
+
+            size_type c = symbol(key[i]);
+            if (n->children[c] != nullptr) { n = n->children[c]; continue; }
+            if (n->buckets[c]  == nullptr) return end();
+
+            pointer v = n->buckets[c]->find(suffix(key, i + 1), key.size() - i - 1);
+            return v == nullptr ? end() : const_iterator(n, c, 0, v);
+        }
+    }
+
+    iterator erase(const_iterator pos) { return erase(remove_const(pos)); }
+    iterator erase(iterator pos) {
+        iterator next = std::next(pos);
+        destroy_and_deallocate(get_allocator(), extract(pos));
+        return next;
+    }
+
+    pointer extract(const_iterator pos) {
+        iterator it = remove_const(pos);
+        if (it.slot == R) it.node->value = nullptr;
+        else {
+            allocator_type alloc = get_allocator();
+            bucket_type*& b = it.node->buckets[it.slot];
+            b->erase(alloc, it.index, it.value);
+            if (b->size() == 0) {
+                destroy_bucket(b);
+                b = nullptr;
+            }
+        }
+        impl_.size--;
+        prune(it.node);
+        return it.value;
+    }
+
+    iterator longest_match(const key_type& key)
+    { return remove_const(const_cast<const hat_trie&>(*this).longest_match(key)); }
+    const_iterator longest_match(const key_type& key) const {
+        const_iterator best = end();
+        node_const_pointer n = &impl_.root;
+        for (size_type i = 0;; ++i) {
+            if (n->value != nullptr) best = const_iterator(n, R, 0, n->value);
+            if (i == key.size()) return best;
+
+            size_type c = symbol(key[i]);
+            if (n->children[c] != nullptr) { n = n->children[c]; continue; }
+            if (n->buckets[c]  == nullptr) return best;
+
+            // Every prefix of the rest of the key is probed, extending its hash one symbol at a time.
+            auto src = suffix(key, i + 1);
+            size_type length = key.size() - i - 1;
+            std::uint64_t h = bucket_type::hash_seed;
+            for (size_type j = 0;; ++j) {
+                if (pointer v = n->buckets[c]->find(h, src, j)) best = const_iterator(n, c, 0, v);
+                if (j == length) return best;
+                h = bucket_type::hash_step(h, src(j));
+            }
+        }
+    }
+
+    std::pair<iterator, iterator> prefixed_with(const key_type& key) {
+        auto p = const_cast<const hat_trie&>(*this).prefixed_with(key);
+        return { remove_const(p.first), remove_const(p.second) };
+    }
+    std::pair<const_iterator, const_iterator>
+    prefixed_with(const key_type& key) const {
+        node_const_pointer n = &impl_.root;
+        for (size_type i = 0;; ++i) {
+            if (i == key.size()) {
+                const_iterator first = const_iterator::first_in(n);
+                if (n->parent == nullptr) return { first, end() };
+                return { first, const_iterator::forward_from(n->parent, n->parent_index + 1) };
+            }
+
+            size_type c = symbol(key[i]);
+            if (n->children[c] != nullptr) { n = n->children[c]; continue; }
+            const bucket_type* b = n->buckets[c];
+            if (b == nullptr) return { end(), end() };
+
+            auto [lo, hi] = b->prefixed_with(suffix(key, i + 1), key.size() - i - 1);
+            if (lo == hi) return { end(), end() };
+            const_iterator first = const_iterator::in_bucket(n, c, lo);
+            if (hi < b->size()) return { first, const_iterator::in_bucket(n, c, hi) };
+            return { first, const_iterator::forward_from(n, c + 1) };
+        }
+    }
+
+    iterator root() noexcept { return remove_const(croot()); }
+    const_iterator root() const noexcept { return croot(); }
+    const_iterator croot() const noexcept { return cend(); }
+
+    iterator begin() noexcept { return remove_const(cbegin()); }
+    const_iterator begin() const noexcept { return cbegin(); }
+    const_iterator cbegin() const noexcept { return const_iterator::first_in(&impl_.root); }
+
+    iterator end() noexcept { return remove_const(cend()); }
+    const_iterator end() const noexcept { return cend(); }
+    const_iterator cend() const noexcept { return &impl_.root; }
+
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(cend()); }
+
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crend() const noexcept { return const_reverse_iterator(cbegin()); }
+
+    size_type size() const noexcept { return impl_.size; }
+
+    void clear() noexcept {
+        clear_hat_node(&impl_.root);
+        impl_.nodes.release(get_node_allocator());
+        impl_.size = 0;
+    }
+
+    allocator_type get_allocator() const { return get_node_allocator(); }
+    key_mapper     key_map()       const { return impl_; }
+
+private:
+    size_type symbol(char_type c) const { return static_cast<const key_mapper&>(impl_)(c); }
+
+    // The mapped symbols of key from position first on.
+    auto suffix(const key_type& key, size_type first) const
+    { return [this, &key, first](size_type i) { return symbol(key[first + i]); }; }
+
+    iterator insert_value(const key_type& key, pointer v) {
+        node_pointer n = &impl_.root;
+        for (size_type i = 0;; ++i) {
+            if (i == key.size()) {
+                if (n->value != nullptr) {
+                    destroy_and_deallocate(get_allocator(), v);
+                    return iterator(n, R, 0, n->value);
+                }
+                n->value = v;
+                ++impl_.size;
+                return iterator(n, R, 0, v);
+            }
+
+            size_type c = symbol(key[i]);
+            if (n->children[c] != nullptr) { n = n->children[c]; continue; }
+
+            bucket_type*& b = n->buckets[c];
+            auto src = suffix(key, i + 1);
+            size_type length = key.size() - i - 1;
+            if (b == nullptr) b = make_bucket();
+            else if (pointer found = b->find(src, length)) {
+                destroy_and_deallocate(get_allocator(), v);
+                return iterator(n, c, 0, found);
+            } else if (b->size() >= burst_threshold) {
+                burst(n, c);
+                n = n->children[c];
+                continue;
+            }
+
+            allocator_type alloc = get_allocator();
+            b->insert(alloc, src, length, v);
+            ++impl_.size;
+            return iterator(n, c, b->size() - 1, v);
+        }
+    }
+
+    // Replaces the bucket in slot c of n with a trie node, spreading its keys over new buckets by
+    // their first symbol.
+    void burst(node_pointer n, size_type c) {
+        allocator_type alloc = get_allocator();
+        bucket_type* b = n->buckets[c];
+        node_pointer m = make_node(n, c);
+        n->buckets[c]  = nullptr;
+        n->children[c] = m;
+
+        b->for_each([&](const auto& r) {
+            if (r.size() == 0) {
+                m->value = r.value();
+                return;
+            }
+            bucket_type*& mb = m->buckets[r[0]];
+            if (mb == nullptr) mb = make_bucket();
+            mb->insert(alloc, [&r](size_type i) { return r[i + 1]; }, r.size() - 1, r.value());
+        });
+        destroy_bucket(b);
+    }
+
+    static bool is_empty(node_const_pointer n) {
+        if (n->value != nullptr) return false;
+        for (size_type c = 0; c < R; ++c)
+            if (n->children[c] != nullptr || n->buckets[c] != nullptr) return false;
+        return true;
+    }
+
+    // Removes nodes left without values on the way up from n.
+    void prune(node_pointer n) {
+        while (n->parent != nullptr && is_empty(n)) {
+            node_pointer parent = n->parent;
+            parent->children[n->parent_index] = nullptr;
+            impl_.nodes.destroy(get_node_allocator(), n);
+            n = parent;
+        }
+    }
+
+    void clear_hat_node(node_pointer n) noexcept {
+        auto value_alloc = get_allocator();
+        delete_node_value(n, value_alloc);
+        for (size_type c = 0; c < R; ++c) {
+            if (n->children[c] != nullptr) {
+                clear_hat_node(n->children[c]);
+                impl_.nodes.destroy(get_node_allocator(), n->children[c]);
+                n->children[c] = nullptr;
+            }
+            if (n->buckets[c] != nullptr) {
+                n->buckets[c]->for_each([&](const auto& r) { destroy_and_deallocate(value_alloc, r.value()); });
+                destroy_bucket(n->buckets[c]);
+                n->buckets[c] = nullptr;
+            }
+        }
+    }
+
+    const auto& get_node_allocator() const { return impl_; }
+          auto& get_node_allocator()       { return impl_; }
+
+    node_pointer make_node(node_pointer parent, size_type parent_index) {
+        node_pointer n = impl_.nodes.create(get_node_allocator());
+
+        std::fill(std::begin(n->children), std::end(n->children), nullptr);
+        std::fill(std::begin(n->buckets), std::end(n->buckets), nullptr);
+        n->parent = parent;
+        n->value = nullptr;
+        n->parent_index = parent_index;
+
+        return n;
+    }
+
+    bucket_type* make_bucket() {
+        bucket_allocator_type alloc(get_node_allocator());
+        bucket_type* b = bucket_alloc_traits::allocate(alloc, 1);
+        bucket_alloc_traits::construct(alloc, b);
+        return b;
+    }
+
+    void destroy_bucket(bucket_type* b) {
+        allocator_type value_alloc = get_allocator();
+        b->release(value_alloc);
+        bucket_allocator_type alloc(get_node_allocator());
+        destroy_and_deallocate(alloc, b);
+    }
+
+    void copy_tree(const hat_trie& other) {
+        copy_nodes(&other.impl_.root, &impl_.root,
+            [this](const_pointer v) { return make_value(get_allocator(), *v); }
+        );
+        impl_.size = other.impl_.size;
+    }
+
+    void move_tree(hat_trie& other) {
+        copy_nodes(&other.impl_.root, &impl_.root,
+            [this](const_pointer v) { return make_value(get_allocator(), std::move(*const_cast<pointer>(v))); }
+        );
+        impl_.size = other.impl_.size;
+    }
+
+    // Copies the structure below src into dst, making every value with make.
+    template <typename MakeValue>
+    void copy_nodes(node_const_pointer src, node_pointer dst, MakeValue make) {
+        allocator_type alloc = get_allocator();
+        if (src->value != nullptr) dst->value = make(src->value);
+        for (size_type c = 0; c < R; ++c) {
+            if (src->children[c] != nullptr) {
+                dst->children[c] = make_node(dst, c);
+                copy_nodes(src->children[c], dst->children[c], make);
+            }
+            if (src->buckets[c] != nullptr) {
+                bucket_type* b = make_bucket();
+                src->buckets[c]->for_each([&](const auto& r) {
+                    b->insert(alloc, [&r](size_type i) { return r[i]; }, r.size(), make(r.value()));
+                });
+                dst->buckets[c] = b;
+            }
+        }
+    }
+
+    struct hat_trie_header {
+        node_type root;
+        size_type size;
+        node_storage_type nodes;
+
+        hat_trie_header() { reset(); }
+        hat_trie_header& operator=(hat_trie_header&& other) {
+            std::copy(std::begin(other.root.children), std::end(other.root.children), std::begin(root.children));
+            std::copy(std::begin(other.root.buckets), std::end(other.root.buckets), std::begin(root.buckets));
+            root.value = other.root.value;
+            adopt_children();
+            size = other.size;
+            nodes = std::move(other.nodes);
+            other.reset();
+            return *this;
+        }
+
+        void adopt_children() { for (auto child : root.children) if (child != nullptr) child->parent = &root; }
+
+        void reset() {
+            std::fill(std::begin(root.children), std::end(root.children), nullptr);
+            std::fill(std::begin(root.buckets), std::end(root.buckets), nullptr);
+            root.parent = nullptr;
+            root.value = nullptr;
+            root.parent_index = 0;
+
+            size = 0;
+        }
+    };
+
+    struct hat_trie_impl : hat_trie_header, key_mapper, node_allocator_type {
+        hat_trie_impl() = default;
+        hat_trie_impl(node_allocator_type alloc) :
+            hat_trie_header(), key_mapper(), node_allocator_type(std::move(alloc))
+        {}
+        hat_trie_impl(key_mapper km, node_allocator_type alloc) :
+            hat_trie_header(), key_mapper(std::move(km)), node_allocator_type(std::move(alloc))
+        {}
+        hat_trie_impl& operator=(hat_trie_impl&&) = default;
+    };
+
+    hat_trie_impl impl_;
+};
+
+} // namespace rmr::detail
@@ -0,0 +1,116 @@
+// Armor
+//
+// Copyright Ron Mordechai, 2018
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace rmr::detail {
+
+// Node storage policies. A storage hands out constructed nodes from a node allocator which is
+// passed in on every call, the same way array_list takes its allocator.
+
+template <typename Node>
+class node_heap {
+public:
+    template <typename Allocator>
+    Node* create(Allocator& alloc) {
+        using traits = std::allocator_traits<Allocator>;
+        Node* n = traits::allocate(alloc, 1);
+        traits::construct(alloc, n);
+        return n;
+    }
+
+    template <typename Allocator>
+    void destroy(Allocator& alloc, Node* n) noexcept {
+        using traits = std::allocator_traits<Allocator>;
+        traits::destroy(alloc, n);
+        traits::deallocate(alloc, n, 1);
+    }
+
+    template <typename Allocator>
+    void release(Allocator&) noexcept {}
+
+    void swap(node_heap&) noexcept {}
+};
+
+template <typename Node, std::size_t ChunkBytes = 64 * 1024>
+class node_pool {
+public:
+    // The first node of every chunk links to the previous chunk.
+    static constexpr std::size_t chunk_size = std::max<std::size_t>(ChunkBytes / sizeof(Node), 2);
+
+    node_pool() = default;
+    node_pool(const node_pool&) = delete;
+    node_pool(node_pool&& other) noexcept { swap(other); }
+    ~node_pool() = default;
+
+    node_pool& operator=(const node_pool&) = delete;
+    node_pool& operator=(node_pool&& other) noexcept { swap(other); return *this; }
+
+    template <typename Allocator>
+    Node* create(Allocator& alloc) {
+        Node* n;
+        if (free_ != nullptr) {
+            n = free_;
+            free_ = next_of(free_);
+        } else {
+            if (cursor_ == last_) grow(alloc);
+            n = cursor_++;
+        }
+        std::allocator_traits<Allocator>::construct(alloc, n);
+        return n;
+    }
+
+    template <typename Allocator>
+    void destroy(Allocator& alloc, Node* n) noexcept {
+        std::allocator_traits<Allocator>::destroy(alloc, n);
+        link(n, free_);
+        free_ = n;
+    }
+
+    template <typename Allocator>
+    void release(Allocator& alloc) noexcept {
+        while (chunks_ != nullptr) {
+            Node* next = next_of(chunks_);
+            std::allocator_traits<Allocator>::deallocate(alloc, chunks_, chunk_size);
+            chunks_ = next;
+        }
+        free_ = cursor_ = last_ = nullptr;
+    }
+
+    void swap(node_pool& other) noexcept {
+        using std::swap;
+        swap(chunks_, other.chunks_);
+        swap(free_,   other.free_);
+        swap(cursor_, other.cursor_);
+        swap(last_,   other.last_);
+    }
+
+private:
+    template <typename Allocator>
+    void grow(Allocator& alloc) {
+        Node* chunk = std::allocator_traits<Allocator>::allocate(alloc, chunk_size);
+        link(chunk, chunks_);
+        chunks_ = chunk;
+        cursor_ = chunk + 1;
+        last_   = chunk + chunk_size;
+    }
+
+    static void  link(Node* n, Node* next) { ::new (static_cast<void*>(n)) Node*(next); }
+    static Node* next_of(Node* n) { return *std::launder(reinterpret_cast<Node**>(n)); }
+
+    Node* chunks_ = nullptr;
+    Node* free_   = nullptr;
+    Node* cursor_ = nullptr;
+    Node* last_   = nullptr;
+};
+
+} // namespace rmr::detail
@@ -0,0 +1,483 @@
+// Armor
+//
+// Copyright Ron Mordechai, 2018
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <algorithm>
+#include <memory>
+
+#include <rmr/detail/symbol_search.h>
+#include <rmr/detail/trie_node_base.h>
+#include <rmr/detail/util.h>
+#include <rmr/options.h>
+
+namespace rmr::detail {
+
+// Leaves hold the values, internal nodes hold the index of the bit they branch on. Every internal
+// node has exactly two children.
+template <typename T>
+struct patricia_trie_node : trie_node_base<patricia_trie_node<T>, T, 2> { std::size_t bit; };
+
+template <typename Node>
+struct patricia_trie_iterator_traits : trie_iterator_traits_base<2, Node> {
+    template <typename _Node>
+    using rebind = patricia_trie_iterator_traits<_Node>;
+
+    static bool is_leaf(Node n) { return n->value != nullptr; }
+
+    static Node leftmost(Node n) {
+        while (!is_leaf(n)) n = n->children[0];
+        return n;
+    }
+
+    static Node rightmost(Node n) {
+        while (!is_leaf(n)) n = n->children[1];
+        return n;
+    }
+
+    // The first leaf after the subtree of n. The tree hangs off the left of the base node.
+    static Node skip(Node n) {
+        while (n->parent->parent != nullptr && n == n->parent->children[1]) n = n->parent;
+        if (n->parent->parent == nullptr) return n->parent;
+        return leftmost(n->parent->children[1]);
+    }
+
+    static Node next(Node n) {
+        if (n->parent == nullptr) return n->children[0] == nullptr ? n : leftmost(n->children[0]);
+        return skip(n);
+    }
+
+    static Node prev(Node n) {
+        if (n->parent == nullptr) return n->children[0] == nullptr ? n : rightmost(n->children[0]);
+
+        while (n->parent->parent != nullptr && n == n->parent->children[0]) n = n->parent;
+        if (n->parent->parent == nullptr) return n->parent;
+        return rightmost(n->parent->children[0]);
+    }
+};
+
+// A PATRICIA (crit-bit) tree over the bits of the mapped key symbols. A key is read as a string
+// of bits where every symbol contributes a set presence bit followed by its own bits, and the
+// bits past the end of the key are clear. This orders keys the same way trie does.
+template <
+    typename T, std::size_t R, typename KeyMapper, typename Key, typename Allocator, typename... Options
+>
+class patricia_trie {
+    using alloc_traits        = std::allocator_traits<Allocator>;
+    using node_type           = patricia_trie_node<T>;
+    using node_allocator_type = typename alloc_traits::template rebind_alloc<node_type>;
+    using node_alloc_traits   = typename alloc_traits::template rebind_traits<node_type>;
+    using node_pointer        = typename node_alloc_traits::pointer;
+    using node_const_pointer  = typename node_alloc_traits::const_pointer;
+    using node_storage_type   = node_storage_t<node_type, Options...>;
+
+    using iterator_traits       = patricia_trie_iterator_traits<node_pointer>;
+    using const_iterator_traits = patricia_trie_iterator_traits<node_const_pointer>;
+
+    static_assert(
+        std::is_same_v<find_option_t<node_layout_option, dense_nodes, Options...>, dense_nodes>,
+        "PATRICIA tries do not support node layouts"
+    );
+
+    static constexpr std::size_t symbol_bits() {
+        std::size_t bits = 1;
+        while ((std::size_t(1) << bits) < R) ++bits;
+        return bits;
+    }
+    static constexpr std::size_t stride = symbol_bits() + 1;
+public:
+    using key_type               = Key;
+    using char_type              = typename key_type::value_type;
+    using value_type             = T;
+    using size_type              = std::size_t;
+    using difference_type        = std::ptrdiff_t;
+    using key_mapper             = KeyMapper;
+    using allocator_type         = Allocator;
+    using reference              = value_type&;
+    using const_reference        = const value_type&;
+    using pointer                = typename alloc_traits::pointer;
+    using const_pointer          = typename alloc_traits::const_pointer;
+    using iterator               = trie_iterator<iterator_traits>;
+    using const_iterator         = trie_iterator<const_iterator_traits>;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    patricia_trie() = default;
+    explicit patricia_trie(allocator_type alloc) : impl_(node_allocator_type(std::move(alloc))) {}
+    explicit patricia_trie(key_mapper km, allocator_type alloc) :
+        impl_(std::move(km), node_allocator_type(std::move(alloc)))
+    {}
+
+    patricia_trie(const patricia_trie& other) : patricia_trie(
+        other.key_map(),
+        alloc_traits::select_on_container_copy_construction(other.get_allocator())
+    ) {
+        copy_tree(other);
+    }
+    patricia_trie(const patricia_trie& other, allocator_type alloc) :
+        patricia_trie(other.key_map(), std::move(alloc))
+    {
+        copy_tree(other);
+    }
+
+    patricia_trie(patricia_trie&& other) :
+        patricia_trie(std::move(other.key_map()), std::move(other.get_allocator()))
+    {
+        static_cast<patricia_trie_header&>(impl_) = std::move(static_cast<patricia_trie_header&>(other.impl_));
+    }
+    patricia_trie(patricia_trie&& other, allocator_type alloc) :
+        patricia_trie(std::move(other.key_map()), std::move(alloc))
+    {
+        if (alloc != other.get_allocator()) {
+            move_tree(other);
+            other.clear();
+        } else {
+            static_cast<patricia_trie_header&>(impl_) =
+                std::move(static_cast<patricia_trie_header&>(other.impl_));
+        }
+    }
+    ~patricia_trie() { clear(); }
+
+    patricia_trie& operator=(const patricia_trie& other) {
+        clear();
+        static_cast<key_mapper&>(impl_) = other.key_map();
+        if (alloc_traits::propagate_on_container_copy_assignment::value) {
+            static_cast<node_allocator_type&>(impl_) = other.get_node_allocator();
+        }
+        copy_tree(other);
+        return *this;
+    }
+
+    patricia_trie& operator=(patricia_trie&& other) noexcept(
+        alloc_traits::is_always_equal::value && std::is_nothrow_move_assignable<key_mapper>::value
+    ) {
+        clear();
+        static_cast<key_mapper&>(impl_) = other.key_map();
+        if (alloc_traits::propagate_on_container_move_assignment::value)
+            static_cast<node_allocator_type&>(impl_) = other.get_node_allocator();
+
+        if (!alloc_traits::propagate_on_container_move_assignment::value &&
+                get_allocator() != other.get_allocator()) {
+            move_tree(other);
+        } else {
+            static_cast<patricia_trie_header&>(impl_) =
+                std::move(static_cast<patricia_trie_header&>(other.impl_));
+        }
+
+        other.clear();
+        return *this;
+    }
+
+    void swap(patricia_trie& other) noexcept(
+        alloc_traits::is_always_equal::value && std::is_nothrow_swappable<key_mapper>::value
+    ) {
+        if (alloc_traits::propagate_on_container_swap::value) {
+            node_allocator_type& this_alloc = impl_;
+            static_cast<node_allocator_type&>(impl_) = other.get_node_allocator();
+            other.get_node_allocator() = this_alloc;
+        }
+        key_mapper this_key_map = key_map();
+        static_cast<key_mapper&>(impl_) = other.key_map();
+        static_cast<key_mapper&>(other.impl_) = this_key_map;
+        std::swap(impl_.base.children[0], other.impl_.base.children[0]);
+        impl_.adopt_top();
+        other.impl_.adopt_top();
+        std::swap(impl_.size, other.impl_.size);
+        impl_.nodes.swap(other.impl_.nodes);
+    }
+
+    // Hints are not used, every insertion walks down from the top of the tree.
+    template <typename... Args>
+    iterator emplace(const_iterator, const key_type& key, Args&&... args)
+    { return insert_leaf(key, make_value(get_allocator(), std::forward<Args>(args)...)); }
+
+    iterator reinsert(const_iterator, const key_type& key, const_pointer p)
+    { return insert_leaf(key, const_cast<pointer>(p)); }
+
+    iterator find(const key_type& key)
+    { return remove_const(const_cast<const patricia_trie&>(*this).find(key)); }
+    const_iterator find(const key_type& key) const {
+        node_const_pointer leaf = closest_leaf(key);
+        if (leaf == nullptr || key_of<key_type>(*leaf->value) != key) return end();
+        return leaf;
+    }
+
+    iterator erase(const_iterator pos) { return erase(remove_const(pos)); }
+    iterator erase(iterator pos) {
+        iterator next = std::next(pos);
+        auto value_alloc = get_allocator();
+        delete_node_value(pos.node, value_alloc);
+        remove_leaf(pos.node);
+        return next;
+    }
+
+    pointer extract(const_iterator pos) {
+        node_pointer leaf = remove_const(pos).node;
+        pointer v(std::move(leaf->value));
+        leaf->value = nullptr;
+        remove_leaf(leaf);
+        return v;
+    }
+
+    iterator longest_match(const key_type& key)
+    { return remove_const(const_cast<const patricia_trie&>(*this).longest_match(key)); }
+    const_iterator longest_match(const key_type& key) const {
+        node_const_pointer n = impl_.base.children[0];
+        if (n == nullptr) return end();
+
+        // A stored key which is a proper prefix of key is the left child of the node branching on
+        // the presence bit of the symbol after it.
+        node_const_pointer best = &impl_.base;
+        while (!is_leaf(n)) {
+            if (n->bit % stride == 0 && n->bit / stride < key.size() && is_leaf(n->children[0])) {
+                const key_type& k = key_of<key_type>(*n->children[0]->value);
+                if (k.size() == n->bit / stride && has_prefix(key, k)) best = n->children[0];
+            }
+            n = n->children[bit_of(key, n->bit)];
+        }
+        if (has_prefix(key, key_of<key_type>(*n->value))) best = n;
+        return best;
+    }
+
+    std::pair<iterator, iterator> prefixed_with(const key_type& key) {
+        auto p = const_cast<const patricia_trie&>(*this).prefixed_with(key);
+        return { remove_const(p.first), remove_const(p.second) };
+    }
+    std::pair<const_iterator, const_iterator>
+    prefixed_with(const key_type& key) const {
+        node_const_pointer n = impl_.base.children[0];
+        if (n == nullptr) return { end(), end() };
+
+        // Keys starting with key agree on all bits before the presence bit of the symbol after it.
+        while (!is_leaf(n) && n->bit < key.size() * stride) n = n->children[bit_of(key, n->bit)];
+
+        node_const_pointer first = const_iterator_traits::leftmost(n);
+        if (!has_prefix(key_of<key_type>(*first->value), key)) return { end(), end() };
+        return { first, const_iterator_traits::skip(n) };
+    }
+
+    iterator root() noexcept { return remove_const(croot()); }
+    const_iterator root() const noexcept { return croot(); }
+    const_iterator croot() const noexcept { return &impl_.base; }
+
+    iterator begin() noexcept { return remove_const(cbegin()); }
+    const_iterator begin() const noexcept { return cbegin(); }
+    const_iterator cbegin() const noexcept { return const_iterator_traits::next(&impl_.base); }
+
+    iterator end() noexcept { return remove_const(cend()); }
+    const_iterator end() const noexcept { return cend(); }
+    const_iterator cend() const noexcept { return &impl_.base; }
+
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(cend()); }
+
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crend() const noexcept { return const_reverse_iterator(cbegin()); }
+
+    size_type size() const noexcept { return impl_.size; }
+
+    void clear() noexcept {
+        auto value_alloc = get_allocator();
+        auto& node_alloc = get_node_allocator();
+        if (impl_.base.children[0] != nullptr) {
+            clear_node(impl_.base.children[0], impl_.nodes, node_alloc, value_alloc);
+            impl_.nodes.destroy(node_alloc, impl_.base.children[0]);
+            impl_.base.children[0] = nullptr;
+        }
+        impl_.nodes.release(node_alloc);
+        impl_.size = 0;
+    }
+
+    allocator_type get_allocator() const { return get_node_allocator(); }
+    key_mapper     key_map()       const { return impl_; }
+
+private:
+    static bool is_leaf(node_const_pointer n) { return n->value != nullptr; }
+
+    std::size_t symbol(char_type c) const { return key_map()(c); }
+
+    std::size_t bit_of(const key_type& key, std::size_t bit) const {
+        std::size_t i = bit / stride, r = bit % stride;
+        if (i >= key.size()) return 0;
+        if (r == 0) return 1;
+        return (symbol(key[i]) >> (stride - 1 - r)) & 1;
+    }
+
+    // The first bit at which two different keys differ.
+    std::size_t critical_bit(const key_type& a, const key_type& b) const {
+        std::size_t n = std::min(a.size(), b.size());
+        std::size_t i = common_prefix(a.data(), b.data(), n);
+        if (i == n) return i * stride;
+
+        std::size_t x = symbol(a[i]) ^ symbol(b[i]);
+        std::size_t high = 0;
+        while (x >>= 1) ++high;
+        return i * stride + stride - 1 - high;
+    }
+
+    static bool has_prefix(const key_type& key, const key_type& prefix) {
+        return key.size() >= prefix.size() &&
+            common_prefix(key.data(), prefix.data(), prefix.size()) == prefix.size();
+    }
+
+    // The leaf reached by following the bits of key, which is the only candidate for a match.
+    node_const_pointer closest_leaf(const key_type& key) const {
+        node_const_pointer n = impl_.base.children[0];
+        if (n == nullptr) return nullptr;
+        while (!is_leaf(n)) n = n->children[bit_of(key, n->bit)];
+        return n;
+    }
+
+    node_pointer insert_leaf(const key_type& key, pointer v) {
+        node_pointer leaf = const_cast<node_pointer>(closest_leaf(key));
+        if (leaf == nullptr) {
+            leaf = make_node(&impl_.base, 0, v);
+            impl_.base.children[0] = leaf;
+            ++impl_.size;
+            return leaf;
+        }
+
+        const key_type& other = key_of<key_type>(*leaf->value);
+        if (other == key) {
+            destroy_and_deallocate(get_allocator(), v);
+            return leaf;
+        }
+
+        std::size_t bit = critical_bit(key, other);
+        std::size_t dir = bit_of(key, bit);
+
+        node_pointer parent = &impl_.base;
+        node_pointer n = impl_.base.children[0];
+        while (!is_leaf(n) && n->bit < bit) {
+            parent = n;
+            n = n->children[bit_of(key, n->bit)];
+        }
+
+        node_pointer branch = make_node(parent, bit, nullptr);
+        leaf = make_node(branch, 0, v);
+        branch->children[dir]     = leaf;
+        branch->children[1 - dir] = n;
+        parent->children[parent->children[0] == n ? 0 : 1] = branch;
+        n->parent = branch;
+
+        ++impl_.size;
+        return leaf;
+    }
+
+    // Unlinks a leaf whose value was already taken, replacing its parent with its sibling.
+    void remove_leaf(node_pointer leaf) {
+        auto& node_alloc = get_node_allocator();
+        node_pointer parent = leaf->parent;
+
+        if (parent == &impl_.base) {
+            impl_.base.children[0] = nullptr;
+        } else {
+            node_pointer sibling = parent->children[parent->children[0] == leaf ? 1 : 0];
+            node_pointer grandparent = parent->parent;
+            grandparent->children[grandparent->children[0] == parent ? 0 : 1] = sibling;
+            sibling->parent = grandparent;
+            impl_.nodes.destroy(node_alloc, parent);
+        }
+        impl_.nodes.destroy(node_alloc, leaf);
+        impl_.size--;
+    }
+
+    const auto& get_node_allocator() const { return impl_; }
+          auto& get_node_allocator()       { return impl_; }
+
+    node_pointer make_node(node_pointer parent, std::size_t bit, pointer v) {
+        node_pointer n = impl_.nodes.create(get_node_allocator());
+
+        n->children[0] = n->children[1] = nullptr;
+        n->parent = parent;
+        n->value = v;
+        n->bit = bit;
+
+        return n;
+    }
+
+    void copy_tree(const patricia_trie& other) {
+        if (other.impl_.base.children[0] != nullptr)
+            impl_.base.children[0] = copy_nodes(other.impl_.base.children[0], &impl_.base);
+        impl_.size = other.impl_.size;
+    }
+
+    node_pointer copy_nodes(node_const_pointer src, node_pointer parent) {
+        if (is_leaf(src)) return make_node(parent, 0, make_value(get_allocator(), *src->value));
+
+        node_pointer dst = make_node(parent, src->bit, nullptr);
+        dst->children[0] = copy_nodes(src->children[0], dst);
+        dst->children[1] = copy_nodes(src->children[1], dst);
+        return dst;
+    }
+
+    void move_tree(patricia_trie& other) {
+        auto other_alloc = other.get_allocator();
+        if (other.impl_.base.children[0] != nullptr)
+            impl_.base.children[0] = move_nodes(other_alloc, other.impl_.base.children[0], &impl_.base);
+        impl_.size = other.impl_.size;
+    }
+
+    // Leaves of src keep a value until it is moved so that the tree can still be cleared.
+    node_pointer move_nodes(allocator_type& alloc, node_pointer src, node_pointer parent) {
+        if (is_leaf(src)) {
+            node_pointer dst = make_node(parent, 0, make_value(get_allocator(), std::move(*src->value)));
+            destroy_and_deallocate(alloc, src->value);
+            src->value = nullptr;
+            return dst;
+        }
+
+        node_pointer dst = make_node(parent, src->bit, nullptr);
+        dst->children[0] = move_nodes(alloc, src->children[0], dst);
+        dst->children[1] = move_nodes(alloc, src->children[1], dst);
+        return dst;
+    }
+
+    struct patricia_trie_header {
+        node_type base;
+        size_type size;
+        node_storage_type nodes;
+
+        patricia_trie_header() { reset(); }
+        patricia_trie_header& operator=(patricia_trie_header&& other) {
+            base.children[0] = other.base.children[0];
+            adopt_top();
+            size = other.size;
+            nodes = std::move(other.nodes);
+            other.reset();
+            return *this;
+        }
+
+        void adopt_top() { if (base.children[0] != nullptr) base.children[0]->parent = &base; }
+
+        void reset() {
+            base.children[0] = base.children[1] = nullptr;
+            base.parent = nullptr;
+            base.value = nullptr;
+            base.bit = 0;
+
+            size = 0;
+        }
+    };
+
+    struct patricia_trie_impl : patricia_trie_header, key_mapper, node_allocator_type {
+        patricia_trie_impl() = default;
+        patricia_trie_impl(node_allocator_type alloc) :
+            patricia_trie_header(), key_mapper(), node_allocator_type(std::move(alloc))
+        {}
+        patricia_trie_impl(key_mapper km, node_allocator_type alloc) :
+            patricia_trie_header(), key_mapper(std::move(km)), node_allocator_type(std::move(alloc))
+        {}
+        patricia_trie_impl& operator=(patricia_trie_impl&&) = default;
+    };
+
+    patricia_trie_impl impl_;
+};
+
+} // namespace rmr::detail
@@ -0,0 +1,108 @@
+// Armor
+//
+// Copyright Ron Mordechai, 2018
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__SSE2__) && !defined(ARMOR_NO_SIMD)
+#define ARMOR_SIMD_SYMBOL_SEARCH 1
+#include <emmintrin.h>
+#endif
+
+namespace rmr::detail {
+
+// The narrowest unsigned type holding every symbol of a radix R alphabet.
+template <std::size_t R>
+using trie_symbol_t = std::conditional_t<R <= 0x100, std::uint8_t,
+                      std::conditional_t<R <= 0x10000, std::uint16_t, std::uint32_t>>;
+
+// Position of symbol s among the first count entries of keys, or count if it is not there.
+
+template <typename Symbol>
+std::size_t find_symbol_scalar(const Symbol* keys, std::size_t count, std::size_t s) {
+    std::size_t j = 0;
+    while (j < count && keys[j] != s) ++j;
+    return j;
+}
+
+#ifdef ARMOR_SIMD_SYMBOL_SEARCH
+
+inline std::size_t symbol_mask_position(unsigned mask, std::size_t count) {
+    mask &= (1u << count) - 1;
+    return mask == 0 ? count : static_cast<std::size_t>(__builtin_ctz(mask));
+}
+
+// The whole key array is compared against s at once, entries past count are masked out.
+template <std::size_t N>
+std::size_t find_symbol_simd(const std::uint8_t (&keys)[N], std::size_t count, std::size_t s) {
+    static_assert(N <= 16, "Symbol array does not fit in a vector register");
+    __m128i v;
+    if constexpr (N == 16) v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys));
+    else {
+        std::uint8_t buf[16] = {};
+        std::memcpy(buf, keys, N);
+        v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf));
+    }
+    __m128i eq = _mm_cmpeq_epi8(v, _mm_set1_epi8(static_cast<char>(s)));
+    return symbol_mask_position(static_cast<unsigned>(_mm_movemask_epi8(eq)), count);
+}
+
+template <std::size_t N>
+std::size_t find_symbol_simd(const std::uint16_t (&keys)[N], std::size_t count, std::size_t s) {
+    static_assert(N <= 16, "Symbol array does not fit in two vector registers");
+    std::uint16_t buf[16] = {};
+    std::memcpy(buf, keys, sizeof(keys));
+    __m128i needle = _mm_set1_epi16(static_cast<short>(s));
+    __m128i lo = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(buf)),     needle);
+    __m128i hi = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 8)), needle);
+    // packs turns every 16 bit lane into one byte, keeping its all-ones or all-zeros value.
+    return symbol_mask_position(static_cast<unsigned>(_mm_movemask_epi8(_mm_packs_epi16(lo, hi))), count);
+}
+
+#endif
+
+template <typename Symbol, std::size_t N>
+std::size_t find_symbol(const Symbol (&keys)[N], std::size_t count, std::size_t s) {
+#ifdef ARMOR_SIMD_SYMBOL_SEARCH
+    if constexpr (N <= 16 && (std::is_same_v<Symbol, std::uint8_t> || std::is_same_v<Symbol, std::uint16_t>))
+        return find_symbol_simd(keys, count, s);
+#endif
+    return find_symbol_scalar(keys, count, s);
+}
+
+// Length of the common prefix of the first n characters of a and b.
+
+template <typename Char>
+std::size_t common_prefix_scalar(const Char* a, const Char* b, std::size_t n) {
+    std::size_t i = 0;
+    while (i < n && a[i] == b[i]) ++i;
+    return i;
+}
+
+template <typename Char>
+std::size_t common_prefix(const Char* a, const Char* b, std::size_t n) {
+#ifdef ARMOR_SIMD_SYMBOL_SEARCH
+    if constexpr (sizeof(Char) == 1) {
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            __m128i eq = _mm_cmpeq_epi8(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i))
+            );
+            unsigned mismatch = ~static_cast<unsigned>(_mm_movemask_epi8(eq)) & 0xffff;
+            if (mismatch != 0) return i + static_cast<std::size_t>(__builtin_ctz(mismatch));
+        }
+        return i + common_prefix_scalar(a + i, b + i, n - i);
+    }
+#endif
+    return common_prefix_scalar(a, b, n);
+}
+
+} // namespace rmr::detail
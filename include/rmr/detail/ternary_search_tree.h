@@ -7,8 +7,12 @@
 
 #pragma once
 
+#include <algorithm>
+#include <vector>
+
 #include <rmr/detail/util.h>
 #include <rmr/detail/trie_node_base.h>
+#include <rmr/options.h>
 
 namespace rmr::detail {
 
@@ -51,19 +55,25 @@ struct ternary_search_tree_iterator_traits : trie_iterator_traits_base<3, Node>
         return n;
     }
 
+    // Nodes are visited in order: the left subtree, the node, its middle subtree and then its
+    // right subtree. Skipping goes to the first node after the whole subtree of n.
     static Node skip_forward(Node n) {
-        while (n->parent != nullptr && !is_left_child(n) && children_count(n->parent) == 1) n = n->parent;
+        if (n->parent == nullptr) return n;
 
         if (is_left_child(n)) return n->parent;
-        if (is_middle_child(n) && n->parent->right() != nullptr) return n->parent->right();
-        return skip_forward(n->parent); // is right child
+        if (is_middle_child(n) && n->parent->right() != nullptr) return tree_min(n->parent->right());
+        return skip_forward(n->parent);
     }
 
+    // The last node before the whole subtree of n.
     static Node skip_backward(Node n) {
-        while (n->parent != nullptr && !is_right_child(n) && children_count(n->parent) == 1) n = n->parent;
+        if (n->parent == nullptr) return n;
 
-        if (is_right_child(n)) return n->parent;
-        if (is_middle_child(n) && n->parent->left() != nullptr) return tree_max(n->parent->left());
+        if (is_middle_child(n)) return n->parent;
+        if (is_right_child(n)) {
+            if (n->parent->middle() != nullptr) return tree_max(n->parent->middle());
+            return n->parent;
+        }
         return skip_backward(n->parent); // is left child
     }
 
@@ -74,13 +84,12 @@ struct ternary_search_tree_iterator_traits : trie_iterator_traits_base<3, Node>
     }
 
     static Node prev(Node n) {
-        if (n->left()   != nullptr) return tree_max(n->left());
-        if (n->middle() != nullptr) return tree_max(n->middle());
+        if (n->left() != nullptr) return tree_max(n->left());
         return skip_backward(n);
     }
 };
 
-template <typename T, typename Compare, typename Key, typename Allocator>
+template <typename T, typename Compare, typename Key, typename Allocator, typename... Options>
 class ternary_search_tree {
     static constexpr std::size_t R = 3;
     using alloc_traits = std::allocator_traits<Allocator>;
@@ -102,6 +111,7 @@ private:
     using node_alloc_traits     = typename alloc_traits::template rebind_traits<node_type>;
     using node_pointer          = typename node_alloc_traits::pointer;
     using node_const_pointer    = typename node_alloc_traits::const_pointer;
+    using node_storage_type     = node_storage_t<node_type, Options...>;
     using iterator_traits       = ternary_search_tree_iterator_traits<node_pointer>;
     using const_iterator_traits = ternary_search_tree_iterator_traits<node_const_pointer>;
 public:
@@ -202,20 +212,68 @@ public:
                 other.impl_.root.children[i]->parent = &other.impl_.root;
         }
         std::swap(impl_.size,   other.impl_.size);
+        std::swap(impl_.extracted, other.impl_.extracted);
         std::swap(impl_.root.c, other.impl_.root.c);
+        impl_.nodes.swap(other.impl_.nodes);
     }
 
     template <typename... Args>
     iterator emplace(const_iterator pos, const key_type& key, Args&&... args)
     { return emplace(remove_const(pos), key, std::forward<Args>(args)...); }
     template <typename... Args>
-    iterator emplace(iterator pos, const key_type& key, Args&&... args)
-    { return insert_node(pos.node, key, make_value(get_allocator(), std::forward<Args>(args)...)); }
+    iterator emplace(iterator pos, const key_type& key, Args&&... args) {
+        node_pointer n = insert_node(pos.node, key, make_value(get_allocator(), std::forward<Args>(args)...));
+        prune_extracted();
+        return n;
+    }
 
     iterator reinsert(const_iterator pos, const key_type& key, const_pointer p)
     { return reinsert(remove_const(pos), key, const_cast<pointer>(p)); }
-    iterator reinsert(iterator pos, const key_type& key, pointer p)
-    { return insert_node(pos.node, key, p); }
+    iterator reinsert(iterator pos, const key_type& key, pointer p) {
+        node_pointer n = insert_node(pos.node, key, p);
+        prune_extracted();
+        return n;
+    }
+
+    // Replaces the contents with the values in [first, last). The tree is built top down with the
+    // middle value of every range at its root, so it comes out balanced and its nodes are allocated
+    // in the order they are visited. Input which is not in tree order is sorted first, the first of
+    // repeated keys is kept.
+    template <typename InputIterator>
+    void assign_sorted(InputIterator first, InputIterator last) {
+        clear();
+
+        std::vector<pointer> values, empty;
+        try {
+            for (; first != last; ++first) {
+                pointer v = make_value(get_allocator(), *first);
+                (key_of<key_type>(*v).empty() ? empty : values).push_back(v);
+            }
+        } catch (...) {
+            for (pointer v : values) destroy_and_deallocate(get_allocator(), v);
+            for (pointer v : empty)  destroy_and_deallocate(get_allocator(), v);
+            throw;
+        }
+
+        auto less = [cmp = key_comp()](pointer a, pointer b) {
+            const key_type& x = key_of<key_type>(*a);
+            const key_type& y = key_of<key_type>(*b);
+            return std::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end(), cmp);
+        };
+        if (!std::is_sorted(values.begin(), values.end(), less))
+            std::stable_sort(values.begin(), values.end(), less);
+
+        auto kept = values.begin();
+        for (auto it = values.begin(); it != values.end(); ++it) {
+            if (kept != values.begin() && !less(*(kept - 1), *it)) destroy_and_deallocate(get_allocator(), *it);
+            else *kept++ = *it;
+        }
+
+        if (kept != values.begin()) build_sorted(
+            &impl_.root, impl_.root.parent, values.data(), values.data() + (kept - values.begin()), 0
+        );
+        for (pointer v : empty) insert_node(&impl_.root, 0, key_of<key_type>(*v), v);
+    }
 
     iterator find(const key_type& key)
     { return remove_const(const_cast<const ternary_search_tree&>(*this).find(key)); }
@@ -227,16 +285,38 @@ public:
         iterator next = std::next(pos);
         erase_node(pos.node);
         impl_.size -= 1;
+        prune_extracted();
         return next;
     }
 
-    pointer extract(const_iterator pos) { return extract_value(remove_const(pos).node); }
+    pointer extract(const_iterator pos) {
+        prune_extracted();
+        return extract_value(remove_const(pos).node);
+    }
 
     iterator longest_match(const key_type& key)
     { return remove_const(const_cast<const ternary_search_tree&>(*this).longest_match(key)); }
     const_iterator longest_match(const key_type& key) const
     { return longest_match(&impl_.root, key); }
 
+    // Batched lookups write f(find(key)) or f(longest_match(key)) to out for every key in
+    // [first, last), in order.
+    template <typename ForwardIterator, typename OutputIterator, typename F>
+    OutputIterator find_many(ForwardIterator first, ForwardIterator last, OutputIterator out, F f) const {
+        return walk_many(first, last, out, [&](node_const_pointer n, node_const_pointer) {
+            return f(const_iterator(n == nullptr || n->value == nullptr ? &impl_.base : n));
+        });
+    }
+
+    template <typename ForwardIterator, typename OutputIterator, typename F>
+    OutputIterator longest_match_many(ForwardIterator first, ForwardIterator last, OutputIterator out, F f) const {
+        return walk_many(first, last, out, [&](node_const_pointer n, node_const_pointer prev) {
+            node_const_pointer pos = n == nullptr ? prev : n;
+            while (pos->value == nullptr && pos->parent != nullptr) pos = pos->parent;
+            return f(const_iterator(pos));
+        });
+    }
+
     std::pair<iterator, iterator> prefixed_with(const key_type& key) {
         auto p = const_cast<const ternary_search_tree&>(*this).prefixed_with(key);
         return { remove_const(p.first), remove_const(p.second) };
@@ -246,7 +326,7 @@ public:
         const_iterator first = find_key_unsafe(&impl_.root, key, 0);
         if (first == end()) return { end(), end() };
         const_iterator last;
-        if (first.node->right() != nullptr) last = first.node->right();
+        if (first.node->right() != nullptr) last = const_iterator_traits::tree_min(first.node->right());
         else                                last = const_iterator_traits::skip_forward(first.node);
 
         if (                first.node->value == nullptr) ++first;
@@ -283,8 +363,10 @@ public:
     void clear() noexcept {
         auto value_alloc = get_allocator();
         auto& node_alloc = get_node_allocator();
-        clear_node(&impl_.root, node_alloc, value_alloc);
+        clear_node(&impl_.root, impl_.nodes, node_alloc, value_alloc);
+        impl_.nodes.release(node_alloc);
         impl_.size = 0;
+        impl_.extracted = nullptr;
     }
 
     allocator_type get_allocator() const { return get_node_allocator(); }
@@ -362,13 +444,36 @@ private:
         return root;
     }
 
+    // Builds the subtree of the values in [first, last), which are sorted and share their first d
+    // characters. The values whose character d is that of the middle value go below n, the rest
+    // to its left and right.
+    node_pointer build_sorted(node_pointer n, node_pointer parent, pointer* first, pointer* last, size_type d) {
+        key_compare cmp = key_comp();
+        auto at = [d](pointer v) { return key_of<key_type>(*v)[d]; };
+
+        pointer* mid = first + (last - first) / 2;
+        char_type c = at(*mid);
+        pointer* lo = std::partition_point(first, mid, [&](pointer v) { return cmp(at(v), c); });
+        pointer* hi = std::partition_point(mid, last, [&](pointer v) { return !cmp(c, at(v)); });
+
+        if (n == nullptr) n = make_node(parent, c);
+        else              n->c = c;
+
+        if (first != lo) n->left() = build_sorted(nullptr, n, first, lo, d);
+
+        pointer* below = lo;
+        if (key_of<key_type>(*below[0]).size() == d + 1) { n->value = *below++; ++impl_.size; }
+        if (below != hi) n->middle() = build_sorted(nullptr, n, below, hi, d + 1);
+
+        if (hi != last) n->right() = build_sorted(nullptr, n, hi, last, d);
+        return n;
+    }
+
     const auto& get_node_allocator() const { return impl_; }
           auto& get_node_allocator()       { return impl_; }
 
     node_pointer make_node(node_pointer parent, char_type c) {
-        auto& node_alloc = get_node_allocator();
-        node_pointer n = node_alloc_traits::allocate(node_alloc, 1);
-        node_alloc_traits::construct(node_alloc, n);
+        node_pointer n = impl_.nodes.create(get_node_allocator());
 
         std::fill(std::begin(n->children), std::end(n->children), nullptr);
         n->parent = parent;
@@ -396,30 +501,96 @@ private:
         else                         return root;
     }
 
+    static constexpr size_type batch_size = 16;
+
+    // Walks keys down in groups of batch_size, one node of every key per round, prefetching the
+    // node each key visits next so that the cache misses of a group overlap. result is given the
+    // node a key ends at, or null if it falls off the tree, and the last node visited.
+    template <typename ForwardIterator, typename OutputIterator, typename Result>
+    OutputIterator walk_many(ForwardIterator first, ForwardIterator last, OutputIterator out, Result result) const {
+        key_compare cmp = key_comp();
+        while (first != last) {
+            const key_type*    keys[batch_size];
+            size_type          pos[batch_size];
+            node_const_pointer nodes[batch_size];
+            node_const_pointer prev[batch_size];
+            size_type          walking[batch_size];
+
+            size_type n = 0;
+            for (; n < batch_size && first != last; ++n, ++first) {
+                keys[n]    = &*first;
+                pos[n]     = 0;
+                nodes[n]   = &impl_.root;
+                prev[n]    = impl_.root.parent;
+                walking[n] = n;
+            }
+
+            // Keys which are done are swapped out of the front of walking.
+            for (size_type live = n; live > 0;) {
+                for (size_type k = 0; k < live;) {
+                    size_type j = walking[k];
+                    node_const_pointer node = nodes[j];
+                    const key_type& key = *keys[j];
+                    char_type c = key[pos[j]];
+                    prev[j] = node;
+
+                    if      (cmp(c, node->c)        ) node = node->left();
+                    else if (cmp(node->c, c)        ) node = node->right();
+                    else if (pos[j] < key.size() - 1) { node = node->middle(); ++pos[j]; }
+                    else                              { walking[k] = walking[--live]; continue; }
+
+                    nodes[j] = node;
+                    if (node == nullptr) { walking[k] = walking[--live]; continue; }
+                    detail::prefetch(node);
+                    ++k;
+                }
+            }
+
+            for (size_type j = 0; j < n; ++j) *out++ = result(nodes[j], prev[j]);
+        }
+        return out;
+    }
+
     void erase_node(node_pointer node) {
+        auto value_alloc = get_allocator();
+        delete_node_value(node, value_alloc);
+        prune_node(node);
+    }
+
+    // Removes node and the chain of valueless single child nodes above it if node has neither a
+    // value nor children.
+    void prune_node(node_pointer node) {
         auto value_alloc = get_allocator();
         auto& node_alloc = get_node_allocator();
 
-        delete_node_value(node, value_alloc);
-        if (children_count(node) == 0) {
+        if (node->value == nullptr && children_count(node) == 0 && node != &impl_.root) {
             node_pointer parent = node->parent;
             while (children_count(parent) == 1 && parent != &impl_.root && parent->value == nullptr) {
                 node   = node->parent;
                 parent = node->parent;
             }
             unlink(node);
-            clear_node(node, node_alloc, value_alloc);
+            clear_node(node, impl_.nodes, node_alloc, value_alloc);
+            impl_.nodes.destroy(node_alloc, node);
         }
     }
 
     pointer extract_value(node_pointer node) {
         pointer v(std::move(node->value));
         node->value = nullptr;
-        erase_node(node);
         impl_.size--;
+        if (children_count(node) == 0 && node != &impl_.root) impl_.extracted = node;
         return v;
     }
 
+    // The emptied path of an extracted value is left in place until the next change, so that
+    // hints into it stay usable for reinsertion, and is pruned then.
+    void prune_extracted() {
+        node_pointer n = impl_.extracted;
+        impl_.extracted = nullptr;
+        if (n != nullptr) prune_node(n);
+    }
+
     node_const_pointer longest_match(node_const_pointer root, const key_type& key) const {
         auto pos = longest_match_candidate(root, root->parent, key, 0);
         while (pos->value == nullptr && pos->parent != nullptr) pos = pos->parent;
@@ -444,6 +615,8 @@ private:
         node_type base;
         node_type root;
         size_type size;
+        node_type* extracted;
+        node_storage_type nodes;
 
         ternary_search_tree_header() { reset(); }
         ternary_search_tree_header& operator=(ternary_search_tree_header&& other) {
@@ -452,6 +625,8 @@ private:
                 if (root.children[i] != nullptr) root.children[i]->parent = &root;
             }
             size = other.size;
+            extracted = other.extracted;
+            nodes = std::move(other.nodes);
             other.reset();
             return *this;
         }
@@ -467,6 +642,7 @@ private:
             root.value = nullptr;
 
             size = 0;
+            extracted = nullptr;
         }
     };
 
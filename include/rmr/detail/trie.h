@@ -7,86 +7,121 @@
 
 #pragma once
 
+#include <algorithm>
+#include <vector>
+
+#include <rmr/detail/adaptive_trie_node.h>
+#include <rmr/detail/child_bitmap.h>
 #include <rmr/detail/util.h>
 #include <rmr/detail/trie_node_base.h>
+#include <rmr/options.h>
 
 namespace rmr::detail {
 
 template <typename T, std::size_t R>
-struct trie_node : trie_node_base<trie_node<T, R>, T, R> { std::size_t parent_index; };
+struct trie_node : trie_node_base<trie_node<T, R>, T, R> {
+    std::size_t parent_index;
+    child_bitmap<R> occupied;
+};
+
+// Node layouts give the trie uniform access to the children of a node. The dense layout keeps a
+// full children[R] array in every node, along with a bitmap of the occupied slots which it steps
+// through and counts children with.
+template <typename Node, std::size_t R>
+struct dense_layout {
+    using node_type = Node;
+
+    static constexpr std::size_t radix = R;
+
+    static void init(node_type* n) {
+        std::fill(std::begin(n->children), std::end(n->children), nullptr);
+        n->occupied.clear();
+    }
+    static void init_base(node_type* base, node_type* root) {
+        init(base);
+        base->children[0] = root;
+        base->occupied.set(0);
+    }
+
+    static node_type* child(const node_type* n, std::size_t i) { return n->children[i]; }
+    static void prefetch(const node_type* n, std::size_t i) { detail::prefetch(&n->children[i]); }
+
+    static std::size_t next(const node_type* n, std::size_t pos) { return n->occupied.next(pos); }
+    static std::size_t prev(const node_type* n, std::size_t pos) { return n->occupied.prev(pos); }
+
+    static std::size_t count(const node_type* n) { return n->occupied.count(); }
+
+    template <typename Allocator>
+    static void attach(Allocator&, node_type* n, std::size_t i, node_type* c) {
+        n->children[i] = c;
+        n->occupied.set(i);
+    }
+    template <typename Allocator>
+    static void detach(Allocator&, node_type* n, std::size_t i) {
+        n->children[i] = nullptr;
+        n->occupied.reset(i);
+    }
+    template <typename Allocator>
+    static void release(Allocator&, node_type* n) { init(n); }
+
+    static void take_children(node_type* dst, node_type* src) {
+        std::copy(std::begin(src->children), std::end(src->children), std::begin(dst->children));
+        dst->occupied = src->occupied;
+        init(src);
+    }
+    static void swap_children(node_type* a, node_type* b) {
+        std::swap_ranges(std::begin(a->children), std::end(a->children), std::begin(b->children));
+        a->occupied.swap(b->occupied);
+    }
+};
 
 template <typename T, std::size_t R>
-void unlink(trie_node<T, R>* n) { n->parent->children[n->parent_index] = nullptr; }
+struct dense_trie_layout : dense_layout<trie_node<T, R>, R> {};
 
-template <std::size_t R, typename Node>
-struct trie_iterator_traits : trie_iterator_traits_base<R, Node> {
+template <typename Layout, typename Node>
+struct trie_iterator_traits : trie_iterator_traits_base<Layout::radix, Node> {
     template <typename _Node>
-    using rebind = trie_iterator_traits<R, _Node>;
+    using rebind = trie_iterator_traits<Layout, _Node>;
+
+    static constexpr std::size_t R = Layout::radix;
 
     static std::pair<Node, bool> step_down_forward(Node n) {
-        for (std::size_t pos = 0; pos < R; ++pos) {
-            if (n->children[pos] != nullptr) {
-                n = n->children[pos];
-                return {n, true};
-            }
-        }
-        return {n, false};
+        std::size_t pos = Layout::next(n, 0);
+        if (pos == R) return {n, false};
+        return {Layout::child(n, pos), true};
     }
 
     static std::pair<Node, bool> step_down_backward(Node n) {
-        for (std::size_t pos_ = R; pos_ > 0; --pos_) {
-            std::size_t pos = pos_ - 1;
-
-            if (n->children[pos] != nullptr) {
-                n = n->children[pos];
-                return {n, true};
-            }
-        }
-        return {n, false};
+        std::size_t pos = Layout::prev(n, R);
+        if (pos == R) return {n, false};
+        return {Layout::child(n, pos), true};
     }
 
     static std::pair<Node, bool> step_right(Node n) {
         if (n->parent == nullptr) return {n, false};
 
-        for (std::size_t pos = n->parent_index + 1; pos < R; ++pos) {
-            Node parent = n->parent;
-            if (parent->children[pos] != nullptr) {
-                n = parent->children[pos];
-                return {n, true};
-            }
-        }
-        return {n, false};
+        std::size_t pos = Layout::next(n->parent, n->parent_index + 1);
+        if (pos == R) return {n, false};
+        return {Layout::child(n->parent, pos), true};
     }
 
     static std::pair<Node, bool> step_left(Node n) {
         if (n->parent_index == 0) return {n, false};
 
-        for (std::size_t pos_ = n->parent_index; pos_ > 0; --pos_) {
-            std::size_t pos = pos_ - 1;
+        std::size_t pos = Layout::prev(n->parent, n->parent_index);
+        if (pos == R) return {n, false};
+        n = Layout::child(n->parent, pos);
 
-            Node parent = n->parent;
-            if (parent->children[pos] != nullptr) {
-                n = parent->children[pos];
-
-                bool stepped;
-                do std::tie(n, stepped) = step_down_backward(n); while (stepped);
+        bool stepped;
+        do std::tie(n, stepped) = step_down_backward(n); while (stepped);
 
-                return {n, true};
-            }
-        }
-        return {n, false};
+        return {n, true};
     }
-
     static std::pair<Node, bool> step_up_forward(Node n) {
         n = n->parent;
         return step_right(n);
     }
 
-    static std::pair<Node, bool> step_up_backward(Node n) {
-        n = n->parent;
-        if (n->value != nullptr) return {n, true};
-        return step_left(n);
-    }
 
     static Node skip(Node n) {
         bool stepped;
@@ -109,34 +144,37 @@ struct trie_iterator_traits : trie_iterator_traits_base<R, Node> {
         return skip(n);
     }
 
+    // A node comes after all of its ancestors, so stepping back from a node goes to the last node
+    // under its left sibling, or to its parent. Stepping back from the base goes to the last node.
     static Node prev(Node n) {
         bool stepped;
 
-        std::tie(n, stepped) = step_down_backward(n);
-        if (stepped) return n;
+        if (n->parent == nullptr) {
+            do std::tie(n, stepped) = step_down_backward(n); while (stepped);
+            return n;
+        }
 
         std::tie(n, stepped) = step_left(n);
         if (stepped) return n;
-
-        while (n->parent != nullptr) {
-            std::tie(n, stepped) = step_up_backward(n);
-            if (stepped) return n;
-        }
-        return n;
+        return n->parent;
     }
 };
 
-template <typename T, std::size_t R, typename KeyMapper, typename Key, typename Allocator>
+template <
+    typename T, std::size_t R, typename KeyMapper, typename Key, typename Allocator, typename... Options
+>
 class trie {
     using alloc_traits        = std::allocator_traits<Allocator>;
-    using node_type           = trie_node<T, R>;
+    using layout_type         = node_layout_t<T, R, Options...>;
+    using node_type           = typename layout_type::node_type;
     using node_allocator_type = typename alloc_traits::template rebind_alloc<node_type>;
     using node_alloc_traits   = typename alloc_traits::template rebind_traits<node_type>;
     using node_pointer        = typename node_alloc_traits::pointer;
     using node_const_pointer  = typename node_alloc_traits::const_pointer;
+    using node_storage_type   = node_storage_t<node_type, Options...>;
 
-    using iterator_traits       = trie_iterator_traits<R, node_pointer>;
-    using const_iterator_traits = trie_iterator_traits<R, node_const_pointer>;
+    using iterator_traits       = trie_iterator_traits<layout_type, node_pointer>;
+    using const_iterator_traits = trie_iterator_traits<layout_type, node_const_pointer>;
 public:
     using key_type               = Key;
     using char_type              = typename key_type::value_type;
@@ -227,27 +265,63 @@ public:
         key_mapper this_key_map = key_map();
         static_cast<key_mapper&>(impl_) = other.key_map();
         static_cast<key_mapper&>(other.impl_) = this_key_map;
-        for (size_type i = 0; i < R; ++i) {
-            std::swap(impl_.root.children[i], other.impl_.root.children[i]);
-            if (impl_.root.children[i] != nullptr)
-                impl_.root.children[i]->parent = &impl_.root;
-            if (other.impl_.root.children[i] != nullptr)
-                other.impl_.root.children[i]->parent = &other.impl_.root;
-        }
+        layout_type::swap_children(&impl_.root, &other.impl_.root);
+        adopt_children(&impl_.root);
+        adopt_children(&other.impl_.root);
         std::swap(impl_.size, other.impl_.size);
+        std::swap(impl_.extracted, other.impl_.extracted);
+        impl_.nodes.swap(other.impl_.nodes);
     }
 
     template <typename... Args>
     iterator emplace(const_iterator pos, const key_type& key, Args&&... args)
     { return emplace(remove_const(pos), key, std::forward<Args>(args)...); }
     template <typename... Args>
-    iterator emplace(iterator pos, const key_type& key, Args&&... args)
-    { return insert_node(pos.node, key, make_value(get_allocator(), std::forward<Args>(args)...)); }
+    iterator emplace(iterator pos, const key_type& key, Args&&... args) {
+        node_pointer n = insert_node(pos.node, key, make_value(get_allocator(), std::forward<Args>(args)...));
+        prune_extracted();
+        return n;
+    }
 
     iterator reinsert(const_iterator pos, const key_type& key, const_pointer p)
     { return reinsert(remove_const(pos), key, const_cast<pointer>(p)); }
-    iterator reinsert(iterator pos, const key_type& key, pointer p)
-    { return insert_node(pos.node, key, p); }
+    iterator reinsert(iterator pos, const key_type& key, pointer p) {
+        node_pointer n = insert_node(pos.node, key, p);
+        prune_extracted();
+        return n;
+    }
+
+    // Replaces the contents with the values in [first, last). Every key starts from the path of
+    // the key before it, so input in trie order is built in one pass with its nodes allocated in
+    // iteration order. Other input is still accepted, the first of repeated keys is kept.
+    template <typename InputIterator>
+    void assign_sorted(InputIterator first, InputIterator last) {
+        clear();
+
+        std::vector<node_pointer> path{ &impl_.root };
+        const key_type* prev = nullptr;
+        for (; first != last; ++first) {
+            pointer v = make_value(get_allocator(), *first);
+            const key_type& key = key_of<key_type>(*v);
+
+            path.resize((prev == nullptr ? 0 : shared_prefix(*prev, key)) + 1);
+            for (size_type i = path.size() - 1; i < key.size(); ++i) {
+                node_pointer n = path.back();
+                size_type index = key_map()(key[i]);
+                node_pointer child = layout_type::child(n, index);
+                if (child == nullptr) {
+                    child = make_node(n, index);
+                    layout_type::attach(get_node_allocator(), n, index, child);
+                }
+                path.push_back(child);
+            }
+
+            node_pointer n = path.back();
+            if (n->value == nullptr) { n->value = v; ++impl_.size; }
+            else                     destroy_and_deallocate(get_allocator(), v);
+            prev = &key_of<key_type>(*n->value);
+        }
+    }
 
     iterator find(const key_type& key)
     { return remove_const(const_cast<const trie&>(*this).find(key)); }
@@ -259,16 +333,36 @@ public:
         iterator next = std::next(pos);
         erase_node(pos.node);
         impl_.size--;
+        prune_extracted();
         return next;
     }
 
-    pointer extract(const_iterator pos) { return extract_value(remove_const(pos).node); }
+    pointer extract(const_iterator pos) {
+        prune_extracted();
+        return extract_value(remove_const(pos).node);
+    }
 
     iterator longest_match(const key_type& key)
     { return remove_const(const_cast<const trie&>(*this).longest_match(key)); }
     const_iterator longest_match(const key_type& key) const
     { return longest_match(&impl_.root, key.begin(), key.end()); }
 
+    // Batched lookups write f(find(key)) or f(longest_match(key)) to out for every key in
+    // [first, last), in order.
+    template <typename ForwardIterator, typename OutputIterator, typename F>
+    OutputIterator find_many(ForwardIterator first, ForwardIterator last, OutputIterator out, F f) const {
+        return walk_many(first, last, out, [&](node_const_pointer n, node_const_pointer) {
+            return f(const_iterator(n == nullptr || n->value == nullptr ? &impl_.base : n));
+        });
+    }
+
+    template <typename ForwardIterator, typename OutputIterator, typename F>
+    OutputIterator longest_match_many(ForwardIterator first, ForwardIterator last, OutputIterator out, F f) const {
+        return walk_many(first, last, out, [&](node_const_pointer, node_const_pointer best) {
+            return f(const_iterator(best));
+        });
+    }
+
     std::pair<iterator, iterator> prefixed_with(const key_type& key) {
         auto p = const_cast<const trie&>(*this).prefixed_with(key);
         return { remove_const(p.first), remove_const(p.second) };
@@ -310,7 +404,9 @@ public:
         auto value_alloc = get_allocator();
         auto& node_alloc = get_node_allocator();
         clear_node(&impl_.root, node_alloc, value_alloc);
+        impl_.nodes.release(node_alloc);
         impl_.size = 0;
+        impl_.extracted = nullptr;
     }
 
     allocator_type get_allocator() const { return get_node_allocator(); }
@@ -321,9 +417,9 @@ private:
         if (dst == nullptr) dst = make_node(parent, src->parent_index);
 
         if (src->value != nullptr) dst->value = make_value(get_allocator(), *src->value);
-        for (size_type i = 0; i < R; ++i) {
-            if (src->children[i] != nullptr)
-                dst->children[i] = copy_nodes(src->children[i], dst->children[i], dst);
+        for (size_type i = layout_type::next(src, 0); i < R; i = layout_type::next(src, i + 1)) {
+            node_pointer child = copy_nodes(layout_type::child(src, i), nullptr, dst);
+            layout_type::attach(get_node_allocator(), dst, i, child);
         }
         return dst;
     }
@@ -336,9 +432,9 @@ private:
             destroy_and_deallocate(alloc, src->value);
             src->value = nullptr;
         }
-        for (size_type i = 0; i < R; ++i) {
-            if (src->children[i] != nullptr)
-                dst->children[i] = move_nodes(alloc, src->children[i], dst->children[i], dst);
+        for (size_type i = layout_type::next(src, 0); i < R; i = layout_type::next(src, i + 1)) {
+            node_pointer child = move_nodes(alloc, layout_type::child(src, i), nullptr, dst);
+            layout_type::attach(get_node_allocator(), dst, i, child);
         }
         return dst;
     }
@@ -371,21 +467,31 @@ private:
             ret = root;
         } else {
             size_type parent_index = key_map()(key[index]);
-            auto& child = root->children[parent_index];
-            child = insert_node(child, root, parent_index, key, index + 1, v, ret);
+            node_pointer child = layout_type::child(root, parent_index);
+            if (child != nullptr) insert_node(child, root, parent_index, key, index + 1, v, ret);
+            else layout_type::attach(
+                get_node_allocator(), root, parent_index,
+                insert_node(child, root, parent_index, key, index + 1, v, ret)
+            );
         }
         return root;
     }
 
+    // Length of the longest prefix of a and b which maps to the same path.
+    size_type shared_prefix(const key_type& a, const key_type& b) const {
+        key_mapper km = key_map();
+        size_type i = 0, n = std::min(a.size(), b.size());
+        while (i < n && km(a[i]) == km(b[i])) ++i;
+        return i;
+    }
+
     const auto& get_node_allocator() const { return impl_; }
           auto& get_node_allocator()       { return impl_; }
 
     node_pointer make_node(node_pointer parent, size_type parent_index) {
-        auto& node_alloc = get_node_allocator();
-        node_pointer n = node_alloc_traits::allocate(node_alloc, 1);
-        node_alloc_traits::construct(node_alloc, n);
+        node_pointer n = impl_.nodes.create(get_node_allocator());
 
-        std::fill(std::begin(n->children), std::end(n->children), nullptr);
+        layout_type::init(n);
         n->parent = parent;
         n->parent_index = parent_index;
         n->value = nullptr;
@@ -411,34 +517,112 @@ private:
         if (root == nullptr) return &impl_.base;
         if (cur == last)     return root;
 
-        root = root->children[key_map()(*cur)];
+        root = layout_type::child(root, key_map()(*cur));
         return find_key_unsafe(root, ++cur, last);
     }
 
+    static constexpr size_type batch_size = 16;
+
+    // Walks keys down in groups of batch_size, one symbol of every key per round, prefetching the
+    // slot each key reads next so that the cache misses of a group overlap. result is given the
+    // node a key ends at, or null if it falls off the trie, and the deepest node on its path with
+    // a value, or the base.
+    template <typename ForwardIterator, typename OutputIterator, typename Result>
+    OutputIterator walk_many(ForwardIterator first, ForwardIterator last, OutputIterator out, Result result) const {
+        key_mapper km = key_map();
+        while (first != last) {
+            const key_type*    keys[batch_size];
+            node_const_pointer nodes[batch_size];
+            node_const_pointer best[batch_size];
+            size_type          walking[batch_size];
+
+            size_type n = 0;
+            for (; n < batch_size && first != last; ++n, ++first) {
+                keys[n]    = &*first;
+                nodes[n]   = &impl_.root;
+                best[n]    = &impl_.base;
+                walking[n] = n;
+            }
+
+            // Keys which are done are swapped out of the front of walking.
+            for (size_type i = 0, live = n; live > 0; ++i) {
+                for (size_type k = 0; k < live;) {
+                    size_type j = walking[k];
+                    const key_type& key = *keys[j];
+                    if (nodes[j]->value != nullptr) best[j] = nodes[j];
+                    if (i == key.size()) { walking[k] = walking[--live]; continue; }
+
+                    nodes[j] = layout_type::child(nodes[j], km(key[i]));
+                    if (nodes[j] == nullptr) { walking[k] = walking[--live]; continue; }
+
+                    if (i + 1 < key.size()) layout_type::prefetch(nodes[j], km(key[i + 1]));
+                    else                    detail::prefetch(nodes[j]);
+                    ++k;
+                }
+            }
+
+            for (size_type j = 0; j < n; ++j) *out++ = result(nodes[j], best[j]);
+        }
+        return out;
+    }
+
+    static void adopt_children(node_pointer n) {
+        for (size_type i = layout_type::next(n, 0); i < R; i = layout_type::next(n, i + 1))
+            layout_type::child(n, i)->parent = n;
+    }
+
+    template <typename NodeAllocator, typename ValueAllocator>
+    void clear_node(node_pointer n, NodeAllocator& na, ValueAllocator& va) {
+        delete_node_value(n, va);
+
+        for (size_type i = layout_type::next(n, 0); i < R; i = layout_type::next(n, i + 1)) {
+            node_pointer child = layout_type::child(n, i);
+            clear_node(child, na, va);
+            impl_.nodes.destroy(na, child);
+        }
+        layout_type::release(na, n);
+    }
+
     void erase_node(node_pointer node) {
+        auto value_alloc = get_allocator();
+        delete_node_value(node, value_alloc);
+        prune_node(node);
+    }
+
+    // Removes node and the chain of valueless single child nodes above it if node has neither a
+    // value nor children.
+    void prune_node(node_pointer node) {
         auto value_alloc = get_allocator();
         auto& node_alloc = get_node_allocator();
 
-        delete_node_value(node, value_alloc);
-        if (children_count(node) == 0) {
+        if (node->value == nullptr && layout_type::count(node) == 0 && node != &impl_.root) {
             node_pointer parent = node->parent;
-            while (children_count(parent) == 1 && parent != &impl_.root && parent->value == nullptr) {
+            while (layout_type::count(parent) == 1 && parent != &impl_.root && parent->value == nullptr) {
                 node   = node->parent;
                 parent = node->parent;
             }
-            unlink(node);
+            layout_type::detach(node_alloc, parent, node->parent_index);
             clear_node(node, node_alloc, value_alloc);
+            impl_.nodes.destroy(node_alloc, node);
         }
     }
 
     pointer extract_value(node_pointer node) {
         pointer v(std::move(node->value));
         node->value = nullptr;
-        erase_node(node);
         impl_.size--;
+        if (layout_type::count(node) == 0 && node != &impl_.root) impl_.extracted = node;
         return v;
     }
 
+    // The emptied path of an extracted value is left in place until the next change, so that
+    // hints into it stay usable for reinsertion, and is pruned then.
+    void prune_extracted() {
+        node_pointer n = impl_.extracted;
+        impl_.extracted = nullptr;
+        if (n != nullptr) prune_node(n);
+    }
+
     node_const_pointer longest_match(
         node_const_pointer root,
         typename key_type::const_iterator cur,
@@ -456,7 +640,7 @@ private:
         if (node == nullptr) return prev;
         if (cur == last)     return node;
         prev = node;
-        node = node->children[key_map()(*cur)];
+        node = layout_type::child(node, key_map()(*cur));
         return longest_match_candidate(node, prev, ++cur, last);
     }
 
@@ -464,31 +648,33 @@ private:
         node_type base;
         node_type root;
         size_type size;
+        node_type* extracted;
+        node_storage_type nodes;
 
         trie_header() { reset(); }
         trie_header& operator=(trie_header&& other) {
-            for (size_type i = 0; i < R; ++i) {
-                root.children[i] = other.root.children[i];
-                if (root.children[i] != nullptr) root.children[i]->parent = &root;
-            }
+            layout_type::take_children(&root, &other.root);
+            adopt_children(&root);
             size = other.size;
+            extracted = other.extracted;
+            nodes = std::move(other.nodes);
             other.reset();
             return *this;
         }
 
         void reset() {
-            std::fill(std::begin(base.children), std::end(base.children), nullptr);
-            base.children[0] = &root;
+            layout_type::init_base(&base, &root);
             base.parent = nullptr;
             base.parent_index = R;
             base.value = nullptr;
 
-            std::fill(std::begin(root.children), std::end(root.children), nullptr);
+            layout_type::init(&root);
             root.parent = &base;
             root.parent_index = 0;
             root.value = nullptr;
 
             size = 0;
+            extracted = nullptr;
         }
     };
 
@@ -38,13 +38,14 @@ void delete_node_value(Node* n, ValueAllocator& va) {
 	}
 }
 
-template <typename Node, typename NodeAllocator, typename ValueAllocator>
-void clear_node(Node* n, NodeAllocator& na, ValueAllocator& va) {
+template <typename Node, typename NodeStorage, typename NodeAllocator, typename ValueAllocator>
+void clear_node(Node* n, NodeStorage& ns, NodeAllocator& na, ValueAllocator& va) {
 	delete_node_value(n, va);
 
 	for (auto& child : n->children) {
 		if (child != nullptr) {
-			clear_node(child, na, va);	
+			clear_node(child, ns, na, va);
+			ns.destroy(na, child);
 			child = nullptr;
 		}
 	}
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <memory>
+#include <type_traits>
 
 namespace rmr::detail {
 
@@ -26,4 +27,20 @@ inline typename Alloc::pointer make_value(Alloc&& alloc, Args&&... args) {
     return v;
 }
 
+// The key of a stored value, which is either the key itself or a key-mapped pair.
+template <typename Key, typename Value>
+inline const Key& key_of(const Value& v) {
+    if constexpr (std::is_same_v<Key, Value>) return v;
+    else return v.first;
+}
+
+// A hint that the memory at p is about to be read.
+inline void prefetch(const void* p) {
+#if defined(__GNUC__)
+    __builtin_prefetch(p);
+#else
+    (void)p;
+#endif
+}
+
 } // namespace rmr::detail
@@ -9,6 +9,7 @@
 
 #include <algorithm>
 
+#include <rmr/detail/node_storage.h>
 #include <rmr/detail/util.h>
 #include <rmr/detail/trie_node_base.h>
 
@@ -175,7 +176,7 @@ public:
         auto& node_alloc = get_node_allocator();
         data_.clear(value_alloc);
 
-        clear_node(&impl_.root, node_alloc, value_alloc);
+        clear_node(&impl_.root, impl_.nodes, node_alloc, value_alloc);
         impl_.size = 0;
     }
 
@@ -204,9 +205,7 @@ public:
           auto& get_node_allocator()       { return impl_; }
 
     node_type* make_node() {
-        auto& node_alloc = get_node_allocator();
-        node_type* n = node_alloc_traits::allocate(node_alloc, 1);
-        node_alloc_traits::construct(node_alloc, n);
+        node_type* n = impl_.nodes.create(get_node_allocator());
 
         std::fill(std::begin(n->children), std::end(n->children), nullptr);
         n->value = nullptr;
@@ -218,6 +217,7 @@ public:
     struct word_graph_header {
         node_type root;
         size_type size;
+        node_heap<node_type> nodes;
 
         struct { const_key_iterator first, last; } last_string;
 
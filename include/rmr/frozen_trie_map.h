@@ -0,0 +1,53 @@
+// Armor
+//
+// Copyright Ron Mordechai, 2018
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <stdexcept>
+
+#include <rmr/detail/double_array_trie.h>
+#include <rmr/functors.h>
+#include <rmr/trie_map.h>
+
+namespace rmr {
+
+template <
+    typename T,
+    std::size_t R,
+    typename KeyMapper = identity<std::size_t>,
+    typename Key = std::string,
+    typename Allocator = std::allocator<std::pair<const Key, T>>
+>
+class frozen_trie_map : public detail::double_array_trie<
+    typename Allocator::value_type, R, KeyMapper, Key, Allocator
+> {
+    static_assert(
+        std::is_invocable_r_v<std::size_t, KeyMapper, std::size_t>,
+        "KeyMapper is not invocable with std::size_t or does not return std::size_t"
+    );
+    using base_type = detail::double_array_trie<typename Allocator::value_type, R, KeyMapper, Key, Allocator>;
+public:
+    using base_type::base_type;
+    using mapped_type = T;
+
+    const mapped_type& at(const typename base_type::key_type& k) const {
+        auto it = this->find(k);
+        if (it == this->end()) throw std::out_of_range("rmr::at");
+        return it->second;
+    }
+
+    static constexpr std::size_t radix() { return R; }
+};
+
+// A read-only copy of a trie_map in a double-array layout.
+template <typename T, std::size_t R, typename KeyMapper, typename Key, typename Allocator, typename... Options>
+frozen_trie_map<T, R, KeyMapper, Key, Allocator>
+freeze(const trie_map<T, R, KeyMapper, Key, Allocator, Options...>& t) {
+    return frozen_trie_map<T, R, KeyMapper, Key, Allocator>(t.begin(), t.end(), t.key_map(), t.get_allocator());
+}
+
+} // namespace rmr
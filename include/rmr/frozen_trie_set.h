@@ -0,0 +1,43 @@
+// Armor
+//
+// Copyright Ron Mordechai, 2018
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <rmr/detail/double_array_trie.h>
+#include <rmr/functors.h>
+#include <rmr/trie_set.h>
+
+namespace rmr {
+
+template <
+    std::size_t R,
+    typename KeyMapper = identity<std::size_t>,
+    typename Key = std::string,
+    typename Allocator = std::allocator<Key>
+>
+class frozen_trie_set : public detail::double_array_trie<
+    typename Allocator::value_type, R, KeyMapper, Key, Allocator
+> {
+    static_assert(
+        std::is_invocable_r_v<std::size_t, KeyMapper, std::size_t>,
+        "KeyMapper is not invocable with std::size_t or does not return std::size_t"
+    );
+    using base_type = detail::double_array_trie<typename Allocator::value_type, R, KeyMapper, Key, Allocator>;
+public:
+    using base_type::base_type;
+
+    static constexpr std::size_t radix() { return R; }
+};
+
+// A read-only copy of a trie_set in a double-array layout.
+template <std::size_t R, typename KeyMapper, typename Key, typename Allocator, typename... Options>
+frozen_trie_set<R, KeyMapper, Key, Allocator>
+freeze(const trie_set<R, KeyMapper, Key, Allocator, Options...>& t) {
+    return frozen_trie_set<R, KeyMapper, Key, Allocator>(t.begin(), t.end(), t.key_map(), t.get_allocator());
+}
+
+} // namespace rmr
@@ -0,0 +1,90 @@
+// Armor
+//
+// Copyright Ron Mordechai, 2018
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include <rmr/detail/node_storage.h>
+
+namespace rmr {
+
+namespace detail {
+
+struct node_storage_option {};
+struct node_layout_option {};
+
+template <typename T, std::size_t R> struct dense_trie_layout;
+template <typename T, std::size_t R> struct adaptive_trie_layout;
+
+template <typename T>
+struct option_identity { using type = T; };
+
+template <typename Kind, typename Default, typename... Options>
+struct find_option { using type = Default; };
+
+template <typename Kind, typename Default, typename Option, typename... Options>
+struct find_option<Kind, Default, Option, Options...> : std::conditional_t<
+    std::is_same_v<typename Option::option_kind, Kind>,
+    option_identity<Option>,
+    find_option<Kind, Default, Options...>
+> {};
+
+template <typename Kind, typename Default, typename... Options>
+using find_option_t = typename find_option<Kind, Default, Options...>::type;
+
+} // namespace detail
+
+// Trailing options of the trie based containers, e.g. trie_set<26, KeyMapper, Key, Alloc, pooled_nodes>.
+
+// Every node is a separate allocation from the container's allocator. This is the default.
+struct heap_nodes {
+    using option_kind = detail::node_storage_option;
+    template <typename Node> using storage_type = detail::node_heap<Node>;
+};
+
+// Nodes are carved out of large chunks allocated from the container's allocator, erased nodes are
+// kept on a free list, and all chunks are released together on clear() and destruction.
+struct pooled_nodes {
+    using option_kind = detail::node_storage_option;
+    template <typename Node> using storage_type = detail::node_pool<Node>;
+};
+
+// Every trie node holds a full children[R] array. This is the default.
+struct dense_nodes {
+    using option_kind = detail::node_layout_option;
+    template <typename T, std::size_t R> using layout_type = detail::dense_trie_layout<T, R>;
+};
+
+// Trie nodes grow and shrink between sparse, indexed and dense child layouts as children are
+// added and removed, so that nodes with few children stay small.
+struct adaptive_nodes {
+    using option_kind = detail::node_layout_option;
+    template <typename T, std::size_t R> using layout_type = detail::adaptive_trie_layout<T, R>;
+};
+
+// Marks a range passed to a container constructor as already in the container's order, so that
+// it is built in one pass, see assign_sorted().
+struct sorted_input_t { explicit sorted_input_t() = default; };
+inline constexpr sorted_input_t sorted_input{};
+
+namespace detail {
+
+template <typename T, std::size_t R, typename... Options>
+using node_layout_t = typename find_option_t<
+    node_layout_option, dense_nodes, Options...
+>::template layout_type<T, R>;
+
+template <typename Node, typename... Options>
+using node_storage_t = typename find_option_t<
+    node_storage_option, heap_nodes, Options...
+>::template storage_type<Node>;
+
+} // namespace detail
+
+} // namespace rmr
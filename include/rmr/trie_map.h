@@ -10,6 +10,7 @@
 #include <rmr/detail/map_adaptor.h>
 #include <rmr/detail/trie.h>
 #include <rmr/functors.h>
+#include <rmr/options.h>
 
 namespace rmr {
 
@@ -18,17 +19,18 @@ template <
     std::size_t R,
     typename KeyMapper = identity<std::size_t>,
     typename Key = std::string,
-    typename Allocator = std::allocator<std::pair<const Key, T>>
+    typename Allocator = std::allocator<std::pair<const Key, T>>,
+    typename... Options
 >
 class trie_map : public detail::map_adaptor<
-    T, detail::trie<typename Allocator::value_type, R, KeyMapper, Key, Allocator>
+    T, detail::trie<typename Allocator::value_type, R, KeyMapper, Key, Allocator, Options...>
 > {
     static_assert(
         std::is_invocable_r_v<std::size_t, KeyMapper, std::size_t>,
         "KeyMapper is not invocable with std::size_t or does not return std::size_t"
     );
     using base_type = detail::map_adaptor<
-        T, detail::trie<typename Allocator::value_type, R, KeyMapper, Key, Allocator>
+        T, detail::trie<typename Allocator::value_type, R, KeyMapper, Key, Allocator, Options...>
     >;
 public:
     using base_type::base_type;
@@ -10,6 +10,7 @@
 #include <rmr/detail/set_adaptor.h>
 #include <rmr/detail/trie.h>
 #include <rmr/functors.h>
+#include <rmr/options.h>
 
 namespace rmr {
 
@@ -17,17 +18,18 @@ template <
     std::size_t R,
     typename KeyMapper = identity<std::size_t>,
     typename Key = std::string,
-    typename Allocator = std::allocator<Key>
+    typename Allocator = std::allocator<Key>,
+    typename... Options
 >
 class trie_set : public detail::set_adaptor<
-    detail::trie<typename Allocator::value_type, R, KeyMapper, Key, Allocator>
+    detail::trie<typename Allocator::value_type, R, KeyMapper, Key, Allocator, Options...>
 > {
     static_assert(
         std::is_invocable_r_v<std::size_t, KeyMapper, std::size_t>,
         "KeyMapper is not invocable with std::size_t or does not return std::size_t"
     );
     using base_type = detail::set_adaptor<
-        detail::trie<typename Allocator::value_type, R, KeyMapper, Key, Allocator>
+        detail::trie<typename Allocator::value_type, R, KeyMapper, Key, Allocator, Options...>
     >;
 public:
     using base_type::base_type;
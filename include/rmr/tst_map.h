@@ -11,6 +11,7 @@
 
 #include <rmr/detail/map_adaptor.h>
 #include <rmr/detail/ternary_search_tree.h>
+#include <rmr/options.h>
 
 namespace rmr {
 
@@ -18,17 +19,18 @@ template <
     typename T,
     typename Compare = std::less<char>,
     typename Key = std::string,
-    typename Allocator = std::allocator<std::pair<const Key, T>>
+    typename Allocator = std::allocator<std::pair<const Key, T>>,
+    typename... Options
 >
 class tst_map : public detail::map_adaptor<
-    T, detail::ternary_search_tree<typename Allocator::value_type, Compare, Key, Allocator>
+    T, detail::ternary_search_tree<typename Allocator::value_type, Compare, Key, Allocator, Options...>
 > {
     static_assert(
         std::is_invocable_r_v<bool, Compare, typename Key::value_type, typename Key::value_type>,
         "Compare is not invocable with Key::value_type or does not return bool"
     );
     using base_type = detail::map_adaptor<
-        T, detail::ternary_search_tree<typename Allocator::value_type, Compare, Key, Allocator>
+        T, detail::ternary_search_tree<typename Allocator::value_type, Compare, Key, Allocator, Options...>
     >;
 public:
     using base_type::base_type;
@@ -11,23 +11,25 @@
 
 #include <rmr/detail/set_adaptor.h>
 #include <rmr/detail/ternary_search_tree.h>
+#include <rmr/options.h>
 
 namespace rmr {
 
 template <
     typename Compare = std::less<char>,
     typename Key = std::string,
-    typename Allocator = std::allocator<Key>
+    typename Allocator = std::allocator<Key>,
+    typename... Options
 >
 class tst_set : public detail::set_adaptor<
-    detail::ternary_search_tree<typename Allocator::value_type, Compare, Key, Allocator>
+    detail::ternary_search_tree<typename Allocator::value_type, Compare, Key, Allocator, Options...>
 > {
     static_assert(
         std::is_invocable_r_v<bool, Compare, typename Key::value_type, typename Key::value_type>,
         "Compare is not invocable with Key::value_type or does not return bool"
     );
     using base_type = detail::set_adaptor<
-        detail::ternary_search_tree<typename Allocator::value_type, Compare, Key, Allocator>
+        detail::ternary_search_tree<typename Allocator::value_type, Compare, Key, Allocator, Options...>
     >;
 public:
     using base_type::base_type;
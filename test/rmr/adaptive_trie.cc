@@ -0,0 +1,82 @@
+// Armor
+//
+// Copyright Ron Mordechai, 2018
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "assoc.h"
+
+namespace {
+
+std::vector<std::string> siblings() {
+    std::vector<std::string> keys;
+    for (char c = 1; c < 127; ++c) keys.push_back(std::string("x") + c);
+    return keys;
+}
+
+void expect_contains_exactly(const adaptive_trie_set& t, std::vector<std::string> keys) {
+    std::sort(keys.begin(), keys.end());
+    EXPECT_EQ(keys.size(), t.size());
+    EXPECT_TRUE(std::equal(t.begin(), t.end(), keys.begin(), keys.end()));
+    EXPECT_TRUE(std::equal(t.rbegin(), t.rend(), keys.rbegin(), keys.rend()));
+    for (auto& k : keys) EXPECT_NE(t.end(), t.find(k));
+}
+
+} // namespace
+
+TEST(adaptive_trie, node_grows_through_all_layouts) {
+    auto keys = siblings();
+    std::shuffle(keys.begin(), keys.end(), std::default_random_engine(42));
+
+    adaptive_trie_set t;
+    std::vector<std::string> inserted;
+    for (auto& k : keys) {
+        t.insert(k);
+        inserted.push_back(k);
+        expect_contains_exactly(t, inserted);
+    }
+}
+
+TEST(adaptive_trie, node_shrinks_through_all_layouts) {
+    auto keys = siblings();
+    adaptive_trie_set t(keys.begin(), keys.end());
+
+    std::shuffle(keys.begin(), keys.end(), std::default_random_engine(42));
+    while (!keys.empty()) {
+        t.erase(keys.back());
+        keys.pop_back();
+        expect_contains_exactly(t, keys);
+    }
+}
+
+TEST(adaptive_trie, churn_around_layout_boundaries) {
+    auto keys = siblings();
+    std::default_random_engine engine(7);
+    std::uniform_int_distribution<std::size_t> dist(0, keys.size() - 1);
+
+    adaptive_trie_set t;
+    std::vector<std::string> present;
+    for (int i = 0; i < 2000; ++i) {
+        auto& k = keys[dist(engine) % (i % 3 == 0 ? 60 : keys.size())];
+        auto it = std::find(present.begin(), present.end(), k);
+        if (it == present.end()) { t.insert(k); present.push_back(k); }
+        else                     { t.erase(k);  present.erase(it);    }
+    }
+    expect_contains_exactly(t, present);
+}
+
+TEST(adaptive_trie, prefixed_with_across_layouts) {
+    auto keys = siblings();
+    adaptive_trie_set t(keys.begin(), keys.end());
+    t.insert("y");
+    t.insert("w");
+
+    auto [first, last] = t.prefixed_with("x");
+    EXPECT_EQ(keys.size(), std::distance(first, last));
+    EXPECT_EQ("y", *last);
+}
@@ -11,7 +11,13 @@
 
 #include <gtest/gtest.h>
 
+#include <rmr/compressed_trie_map.h>
+#include <rmr/compressed_trie_set.h>
+#include <rmr/hat_trie_map.h>
+#include <rmr/hat_trie_set.h>
 #include <rmr/meta.h>
+#include <rmr/patricia_trie_map.h>
+#include <rmr/patricia_trie_set.h>
 #include <rmr/trie_map.h>
 #include <rmr/trie_set.h>
 #include <rmr/tst_map.h>
@@ -24,11 +30,45 @@ struct trie_set : rmr::trie_set<127>      { using rmr::trie_set<127>::trie_set;
 struct tst_map : rmr::tst_map<int> { using rmr::tst_map<int>::tst_map; };
 struct tst_set : rmr::tst_set<>    { using rmr::tst_set<>::tst_set;      };
 
-using assoc_map_types    = testing::Types<trie_map, tst_map>;
-using assoc_set_types    = testing::Types<trie_set, tst_set>;
-using assoc_common_types = testing::Types<trie_map, trie_set, tst_map, tst_set>;
-using trie_common_types  = testing::Types<trie_map, trie_set>;
-using tst_common_types   = testing::Types<tst_map, tst_set>;
+struct pooled_trie_set :
+    rmr::trie_set<127, rmr::identity<std::size_t>, std::string, std::allocator<std::string>, rmr::pooled_nodes>
+{ using trie_set::trie_set; };
+struct pooled_tst_map :
+    rmr::tst_map<int, std::less<char>, std::string, std::allocator<std::pair<const std::string, int>>, rmr::pooled_nodes>
+{ using tst_map::tst_map; };
+
+struct adaptive_trie_map :
+    rmr::trie_map<int, 127, rmr::identity<std::size_t>, std::string, std::allocator<std::pair<const std::string, int>>, rmr::adaptive_nodes>
+{ using trie_map::trie_map; };
+struct adaptive_trie_set :
+    rmr::trie_set<127, rmr::identity<std::size_t>, std::string, std::allocator<std::string>, rmr::adaptive_nodes>
+{ using trie_set::trie_set; };
+
+struct compressed_trie_map : rmr::compressed_trie_map<int, 127>
+{ using rmr::compressed_trie_map<int, 127>::compressed_trie_map; };
+struct compressed_trie_set : rmr::compressed_trie_set<127>
+{ using rmr::compressed_trie_set<127>::compressed_trie_set; };
+
+struct patricia_trie_map : rmr::patricia_trie_map<int, 127>
+{ using rmr::patricia_trie_map<int, 127>::patricia_trie_map; };
+struct patricia_trie_set : rmr::patricia_trie_set<127>
+{ using rmr::patricia_trie_set<127>::patricia_trie_set; };
+
+struct hat_trie_map : rmr::hat_trie_map<int, 127> { using rmr::hat_trie_map<int, 127>::hat_trie_map; };
+struct hat_trie_set : rmr::hat_trie_set<127>      { using rmr::hat_trie_set<127>::hat_trie_set;      };
+
+using assoc_map_types = testing::Types<
+    trie_map, tst_map, pooled_tst_map, adaptive_trie_map, compressed_trie_map, patricia_trie_map, hat_trie_map
+>;
+using assoc_set_types = testing::Types<
+    trie_set, tst_set, pooled_trie_set, adaptive_trie_set, compressed_trie_set, patricia_trie_set, hat_trie_set
+>;
+using assoc_common_types = testing::Types<
+    trie_map, trie_set, tst_map, tst_set, pooled_trie_set, pooled_tst_map, adaptive_trie_map, adaptive_trie_set,
+    compressed_trie_map, compressed_trie_set, patricia_trie_map, patricia_trie_set, hat_trie_map, hat_trie_set
+>;
+using trie_common_types  = testing::Types<trie_map, trie_set, pooled_trie_set, adaptive_trie_map, adaptive_trie_set>;
+using tst_common_types   = testing::Types<tst_map, tst_set, pooled_tst_map>;
 
 namespace test {
 
@@ -45,38 +85,20 @@ DEFINE_HAS(mapped_type);
 DEFINE_HAS(key_compare);
 DEFINE_HAS(key_mapper);
 
-template <typename T> typename T::value_type key_to_value(typename T::key_type) = delete;
-
-template <> typename trie_map::value_type key_to_value<trie_map>(typename trie_map::key_type k)
-{ return { k, typename trie_map::mapped_type{} }; }
-template <> typename trie_set::value_type key_to_value<trie_set>(typename trie_set::key_type k)
-{ return k; }
-template <> typename tst_map::value_type key_to_value<tst_map>(typename tst_map::key_type k)
-{ return { k, typename tst_map::mapped_type{} }; }
-template <> typename tst_set::value_type key_to_value<tst_set>(typename tst_set::key_type k)
-{ return k; }
-
-template <typename T> typename T::key_type value_to_key(typename T::value_type) = delete;
-
-template <> typename trie_map::key_type value_to_key<trie_map>(typename trie_map::value_type v)
-{ return v.first; }
-template <> typename trie_set::key_type value_to_key<trie_set>(typename trie_set::value_type v)
-{ return v; }
-template <> typename tst_map::key_type value_to_key<tst_map>(typename tst_map::value_type v)
-{ return v.first; }
-template <> typename tst_set::key_type value_to_key<tst_set>(typename tst_set::value_type v)
-{ return v; }
-
-template <typename T> typename T::key_type nh_to_key(typename T::node_type&&) = delete;
-
-template <> typename trie_map::key_type nh_to_key<trie_map>(typename trie_map::node_type&& nh)
-{ return nh.key(); }
-template <> typename trie_set::key_type nh_to_key<trie_set>(typename trie_set::node_type&& nh)
-{ return nh.value(); }
-template <> typename tst_map::key_type nh_to_key<tst_map>(typename tst_map::node_type&& nh)
-{ return nh.key(); }
-template <> typename tst_set::key_type nh_to_key<tst_set>(typename tst_set::node_type&& nh)
-{ return nh.value(); }
+template <typename T> typename T::value_type key_to_value(typename T::key_type k) {
+    if constexpr (rmr::is_detected_v<has_mapped_type, T>) return { k, typename T::mapped_type{} };
+    else return k;
+}
+
+template <typename T> typename T::key_type value_to_key(typename T::value_type v) {
+    if constexpr (rmr::is_detected_v<has_mapped_type, T>) return v.first;
+    else return v;
+}
+
+template <typename T> typename T::key_type nh_to_key(typename T::node_type&& nh) {
+    if constexpr (rmr::is_detected_v<has_mapped_type, T>) return nh.key();
+    else return nh.value();
+}
 
 template <typename T, typename... Keys>
 T make_container(Keys... keys) { return T( { key_to_value<T>(keys)... } ); }
@@ -127,6 +149,41 @@ template <typename Alloc>
 struct replace_alloc<Alloc, tst_set>
 { using type = rmr::tst_set<std::less<char>, std::string, Alloc>; };
 
+template <typename Alloc>
+struct replace_alloc<Alloc, pooled_trie_set>
+{ using type = rmr::trie_set<127, rmr::identity<std::size_t>, std::string, Alloc, rmr::pooled_nodes>; };
+template <typename Alloc>
+struct replace_alloc<Alloc, pooled_tst_map>
+{ using type = rmr::tst_map<int, std::less<char>, std::string, Alloc, rmr::pooled_nodes>; };
+
+template <typename Alloc>
+struct replace_alloc<Alloc, adaptive_trie_map>
+{ using type = rmr::trie_map<int, 127, rmr::identity<std::size_t>, std::string, Alloc, rmr::adaptive_nodes>; };
+template <typename Alloc>
+struct replace_alloc<Alloc, adaptive_trie_set>
+{ using type = rmr::trie_set<127, rmr::identity<std::size_t>, std::string, Alloc, rmr::adaptive_nodes>; };
+
+template <typename Alloc>
+struct replace_alloc<Alloc, compressed_trie_map>
+{ using type = rmr::compressed_trie_map<int, 127, rmr::identity<std::size_t>, std::string, Alloc>; };
+template <typename Alloc>
+struct replace_alloc<Alloc, compressed_trie_set>
+{ using type = rmr::compressed_trie_set<127, rmr::identity<std::size_t>, std::string, Alloc>; };
+
+template <typename Alloc>
+struct replace_alloc<Alloc, patricia_trie_map>
+{ using type = rmr::patricia_trie_map<int, 127, rmr::identity<std::size_t>, std::string, Alloc>; };
+template <typename Alloc>
+struct replace_alloc<Alloc, patricia_trie_set>
+{ using type = rmr::patricia_trie_set<127, rmr::identity<std::size_t>, std::string, Alloc>; };
+
+template <typename Alloc>
+struct replace_alloc<Alloc, hat_trie_map>
+{ using type = rmr::hat_trie_map<int, 127, rmr::identity<std::size_t>, std::string, Alloc>; };
+template <typename Alloc>
+struct replace_alloc<Alloc, hat_trie_set>
+{ using type = rmr::hat_trie_set<127, rmr::identity<std::size_t>, std::string, Alloc>; };
+
 template <typename T>
 struct assoc_test {
     bool has_iterator               = rmr::is_detected_v<test::has_iterator, T>;
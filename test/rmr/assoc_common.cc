@@ -5,6 +5,9 @@
 // Distributed under the Boost Software License, Version 1.0.
 // (See accompanying file LICENSE.txt or copy at http://boost.org/LICENSE_1_0.txt)
 
+#include <iterator>
+#include <vector>
+
 #include "assoc.h"
 
 template <typename T>
@@ -78,6 +81,36 @@ TYPED_TEST(assoc_common, iterator_constructor) {
     EXPECT_TRUE(std::equal(t.begin(), t.end(), v.begin()));
 }
 
+TYPED_TEST(assoc_common, sorted_input_constructor) {
+    std::vector<typename TypeParam::value_type> v(
+        TestFixture::roman_trie.begin(), TestFixture::roman_trie.end()
+    );
+
+    TypeParam t(rmr::sorted_input, v.begin(), v.end());
+    EXPECT_EQ(TestFixture::roman_trie, t);
+}
+
+TYPED_TEST(assoc_common, assign_sorted_replaces_contents) {
+    TypeParam t = TestFixture::less_trie;
+    std::vector<typename TypeParam::value_type> v {
+        TestFixture::key_to_value("ruber"),
+        TestFixture::key_to_value("romane"),
+        TestFixture::key_to_value("rubicundus"),
+        TestFixture::key_to_value("romulus"),
+        TestFixture::key_to_value("romane"),
+        TestFixture::key_to_value("rubens"),
+        TestFixture::key_to_value("romanus"),
+        TestFixture::key_to_value("rubicon"),
+        TestFixture::key_to_value("ruber")
+    };
+
+    t.assign_sorted(v.begin(), v.end());
+    EXPECT_EQ(TestFixture::roman_trie, t);
+
+    t.assign_sorted(v.end(), v.end());
+    EXPECT_TRUE(t.empty());
+}
+
 TYPED_TEST(assoc_common, initializer_list_constructor) {
     std::vector<typename TypeParam::value_type> v {
         TestFixture::key_to_value("bar"),
@@ -812,6 +845,39 @@ TYPED_TEST(assoc_common, longest_match_empty) {
     EXPECT_EQ(t.end(), it);
 }
 
+TYPED_TEST(assoc_common, find_many) {
+    TypeParam t = TestFixture::roman_trie;
+    std::vector<std::string> keys{
+        "romane", "qux", "romanus", "", "romulus", "rom", "rubens", "ruber", "rubicon", "rubicundus",
+        "rubiconx", "r", "romanes"
+    };
+    std::vector<typename TypeParam::const_iterator> found(keys.size());
+
+    EXPECT_EQ(found.end(), t.find_many(keys.begin(), keys.end(), found.begin()));
+    for (std::size_t i = 0; i < keys.size(); ++i) EXPECT_EQ(t.find(keys[i]), found[i]) << "key " << keys[i];
+}
+
+TYPED_TEST(assoc_common, count_many) {
+    TypeParam t = TestFixture::roman_trie;
+    std::vector<std::string> keys{
+        "romane", "qux", "romanus", "", "romulus", "rom", "rubens", "ruber", "rubicon", "rubicundus", "r"
+    };
+    std::vector<std::size_t> counts;
+
+    t.count_many(keys.begin(), keys.end(), std::back_inserter(counts));
+    EXPECT_EQ((std::vector<std::size_t>{ 1, 0, 1, 0, 1, 0, 1, 1, 1, 1, 0 }), counts);
+}
+
+TYPED_TEST(assoc_common, longest_match_many) {
+    TypeParam t = TestFixture::make_container("foo", "foobar", "baz", "f", "bazooka");
+    std::vector<std::string> keys{ "fooba", "foobar", "qux", "", "fo", "bazoo", "bazookas", "foobarbaz", "b", "f" };
+    std::vector<typename TypeParam::const_iterator> found(keys.size());
+
+    t.longest_match_many(keys.begin(), keys.end(), found.begin());
+    for (std::size_t i = 0; i < keys.size(); ++i)
+        EXPECT_EQ(t.longest_match(keys[i]), found[i]) << "key " << keys[i];
+}
+
 TYPED_TEST(assoc_common, equals) {
     TypeParam t = TestFixture::roman_trie;
     TypeParam s = TestFixture::roman_trie;
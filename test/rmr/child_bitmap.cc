@@ -0,0 +1,108 @@
+// Armor
+//
+// Copyright Ron Mordechai, 2018
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <rmr/detail/child_bitmap.h>
+
+#include "assoc.h"
+
+namespace {
+
+// Slots past a word boundary and in a partial last word are where the bit arithmetic can slip.
+constexpr std::size_t R = 130;
+
+std::size_t scan_next(const std::vector<bool>& slots, std::size_t pos) {
+    while (pos < R && !slots[pos]) ++pos;
+    return pos;
+}
+
+std::size_t scan_prev(const std::vector<bool>& slots, std::size_t pos) {
+    while (pos > 0) if (slots[--pos]) return pos;
+    return R;
+}
+
+} // namespace
+
+TEST(child_bitmap, matches_scan) {
+    std::default_random_engine engine(42);
+    std::bernoulli_distribution occupied(0.05);
+
+    for (int round = 0; round < 50; ++round) {
+        std::vector<bool> slots(R);
+        rmr::detail::child_bitmap<R> bitmap;
+        bitmap.clear();
+
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < R; ++i) {
+            if (occupied(engine) || i == 63 || i == 64 || (round % 2 && i == R - 1)) {
+                slots[i] = true;
+                bitmap.set(i);
+                ++count;
+            }
+        }
+
+        EXPECT_EQ(count, bitmap.count());
+        for (std::size_t pos = 0; pos <= R; ++pos) {
+            EXPECT_EQ(scan_next(slots, pos), bitmap.next(pos)) << "pos " << pos;
+            EXPECT_EQ(scan_prev(slots, pos), bitmap.prev(pos)) << "pos " << pos;
+        }
+    }
+}
+
+TEST(child_bitmap, reset_and_swap) {
+    rmr::detail::child_bitmap<R> a, b;
+    a.clear();
+    b.clear();
+
+    a.set(0); a.set(64); a.set(129);
+    a.reset(64);
+    EXPECT_EQ(2u, a.count());
+    EXPECT_EQ(129u, a.next(1));
+    EXPECT_EQ(0u, a.prev(129));
+
+    a.swap(b);
+    EXPECT_EQ(0u, a.count());
+    EXPECT_EQ(R, a.next(0));
+    EXPECT_EQ(R, a.prev(R));
+    EXPECT_EQ(0u, b.next(0));
+}
+
+// Children come and go through insert, erase and the merges of the compressed trie, the bitmap
+// has to follow all of them for iteration to stay right.
+TEST(child_bitmap, iteration_after_erase) {
+    std::vector<std::string> keys;
+    std::default_random_engine engine(7);
+    std::uniform_int_distribution<int> symbol('a', 'z');
+    std::uniform_int_distribution<std::size_t> length(0, 6);
+    for (int i = 0; i < 3000; ++i) {
+        std::string k(length(engine), 0);
+        for (auto& c : k) c = static_cast<char>(symbol(engine));
+        keys.push_back(k);
+    }
+
+    trie_set t(keys.begin(), keys.end());
+    compressed_trie_set c(keys.begin(), keys.end());
+    std::set<std::string> expected(keys.begin(), keys.end());
+
+    for (std::size_t i = 0; i < keys.size(); i += 3) {
+        t.erase(keys[i]);
+        c.erase(keys[i]);
+        expected.erase(keys[i]);
+    }
+
+    EXPECT_TRUE(std::equal(t.begin(), t.end(), expected.begin(), expected.end()));
+    EXPECT_TRUE(std::equal(t.rbegin(), t.rend(), expected.rbegin(), expected.rend()));
+    EXPECT_TRUE(std::equal(c.begin(), c.end(), expected.begin(), expected.end()));
+    EXPECT_TRUE(std::equal(c.rbegin(), c.rend(), expected.rbegin(), expected.rend()));
+}
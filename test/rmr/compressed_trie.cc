@@ -0,0 +1,101 @@
+// Armor
+//
+// Copyright Ron Mordechai, 2018
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <vector>
+
+#include "assoc.h"
+
+namespace {
+
+std::vector<std::string> urls() {
+    return {
+        "http://example.com/",
+        "http://example.com/a/very/long/path/which/does/not/fit/in/a/node",
+        "http://example.com/a/very/long/path/which/does/not/fit/in/a/node/either",
+        "http://example.com/a/very/long/road",
+        "http://example.org/",
+        "https://example.com/"
+    };
+}
+
+void expect_contains_exactly(const compressed_trie_set& t, std::vector<std::string> keys) {
+    std::sort(keys.begin(), keys.end());
+    EXPECT_EQ(keys.size(), t.size());
+    EXPECT_TRUE(std::equal(t.begin(), t.end(), keys.begin(), keys.end()));
+    EXPECT_TRUE(std::equal(t.rbegin(), t.rend(), keys.rbegin(), keys.rend()));
+    for (auto& k : keys) EXPECT_NE(t.end(), t.find(k));
+}
+
+} // namespace
+
+TEST(compressed_trie, split_labels) {
+    auto keys = urls();
+    compressed_trie_set t;
+    std::vector<std::string> inserted;
+    for (auto& k : keys) {
+        t.insert(k);
+        inserted.push_back(k);
+        expect_contains_exactly(t, inserted);
+    }
+}
+
+TEST(compressed_trie, merge_labels) {
+    auto keys = urls();
+    compressed_trie_set t(keys.begin(), keys.end());
+    std::rotate(keys.begin(), keys.begin() + 2, keys.end());
+    while (!keys.empty()) {
+        EXPECT_EQ(1u, t.erase(keys.back()));
+        keys.pop_back();
+        expect_contains_exactly(t, keys);
+    }
+}
+
+TEST(compressed_trie, find_does_not_match_inside_labels) {
+    compressed_trie_set t{ "http://example.com/a/very/long/road" };
+    EXPECT_EQ(t.end(), t.find("http://example.com/a/very"));
+    EXPECT_EQ(t.end(), t.find("http://example.com/a/very/long/roads"));
+    EXPECT_EQ(t.end(), t.find("http://example.com/a/very/long/roaf"));
+}
+
+TEST(compressed_trie, prefixed_with_inside_label) {
+    auto keys = urls();
+    compressed_trie_set t(keys.begin(), keys.end());
+
+    auto [first, last] = t.prefixed_with("http://example.com/a/very/lo");
+    EXPECT_EQ(3, std::distance(first, last));
+    EXPECT_EQ("http://example.org/", *last);
+
+    auto [none_first, none_last] = t.prefixed_with("http://example.com/a/very/lox");
+    EXPECT_EQ(none_first, none_last);
+}
+
+TEST(compressed_trie, longest_match_stops_inside_label) {
+    auto keys = urls();
+    compressed_trie_set t(keys.begin(), keys.end());
+
+    EXPECT_EQ("http://example.com/", *t.longest_match("http://example.com/a/very/long/pat"));
+    EXPECT_EQ(
+        "http://example.com/a/very/long/path/which/does/not/fit/in/a/node",
+        *t.longest_match("http://example.com/a/very/long/path/which/does/not/fit/in/a/node/neither")
+    );
+    EXPECT_EQ(t.end(), t.longest_match("http://example.co"));
+}
+
+TEST(compressed_trie, extract_and_reinsert) {
+    auto keys = urls();
+    compressed_trie_set t(keys.begin(), keys.end());
+
+    auto nh = t.extract("http://example.com/a/very/long/road");
+    keys.erase(std::find(keys.begin(), keys.end(), "http://example.com/a/very/long/road"));
+    expect_contains_exactly(t, keys);
+
+    nh.value() = "http://example.com/a/very/long/rope";
+    t.insert(std::move(nh));
+    keys.push_back("http://example.com/a/very/long/rope");
+    expect_contains_exactly(t, keys);
+}
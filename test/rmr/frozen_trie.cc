@@ -0,0 +1,113 @@
+// Armor
+//
+// Copyright Ron Mordechai, 2018
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <rmr/frozen_trie_map.h>
+#include <rmr/frozen_trie_set.h>
+
+#include "assoc.h"
+
+namespace {
+
+std::vector<std::string> random_keys(std::size_t n, std::size_t max_length) {
+    std::default_random_engine engine(42);
+    std::uniform_int_distribution<std::size_t> length(0, max_length);
+    std::uniform_int_distribution<int> symbol('a', 'f');
+
+    std::vector<std::string> keys;
+    for (std::size_t i = 0; i < n; ++i) {
+        std::string k(length(engine), 0);
+        for (auto& c : k) c = static_cast<char>(symbol(engine));
+        keys.push_back(k);
+    }
+    return keys;
+}
+
+} // namespace
+
+TEST(frozen_trie, keeps_trie_order) {
+    auto keys = random_keys(2000, 8);
+    trie_set t(keys.begin(), keys.end());
+    auto f = rmr::freeze(t);
+
+    EXPECT_EQ(t.size(), f.size());
+    EXPECT_TRUE(std::equal(f.begin(), f.end(), t.begin(), t.end()));
+    EXPECT_TRUE(std::equal(f.rbegin(), f.rend(), t.rbegin(), t.rend()));
+}
+
+TEST(frozen_trie, find_and_count) {
+    auto keys = random_keys(2000, 8);
+    trie_set t(keys.begin(), keys.begin() + 1000);
+    auto f = rmr::freeze(t);
+
+    for (auto& k : keys) {
+        auto it = f.find(k);
+        EXPECT_EQ(t.count(k), f.count(k)) << "key " << k;
+        if (t.count(k)) EXPECT_EQ(k, *it);
+        else            EXPECT_EQ(f.end(), it);
+    }
+}
+
+TEST(frozen_trie, prefixed_with_matches_trie) {
+    auto keys = random_keys(2000, 7);
+    trie_set t(keys.begin(), keys.end());
+    auto f = rmr::freeze(t);
+
+    for (auto prefix : { "", "a", "ab", "abc", "ffff", "ca", "abcdefabc", "g" }) {
+        auto [first, last] = f.prefixed_with(prefix);
+        auto [efirst, elast] = t.prefixed_with(prefix);
+        EXPECT_TRUE(std::equal(first, last, efirst, elast)) << "prefix " << prefix;
+    }
+}
+
+TEST(frozen_trie, longest_match_matches_trie) {
+    auto keys = random_keys(500, 6);
+    trie_set t(keys.begin(), keys.end());
+    auto f = rmr::freeze(t);
+
+    for (auto& k : random_keys(300, 10)) {
+        auto it = f.longest_match(k);
+        auto eit = t.longest_match(k);
+        if (eit == t.end()) EXPECT_EQ(f.end(), it) << "key " << k;
+        else                EXPECT_EQ(*eit, *it) << "key " << k;
+    }
+}
+
+TEST(frozen_trie, map_at) {
+    trie_map t{ { "", 0 }, { "a", 1 }, { "ab", 2 }, { "b", 3 } };
+    auto f = rmr::freeze(t);
+
+    EXPECT_EQ(0, f.at(""));
+    EXPECT_EQ(2, f.at("ab"));
+    EXPECT_EQ(3, f.at("b"));
+    EXPECT_THROW(f.at("abc"), std::out_of_range);
+    EXPECT_EQ(1, f.longest_match("az")->second);
+}
+
+TEST(frozen_trie, from_adaptive_nodes) {
+    auto keys = random_keys(500, 6);
+    adaptive_trie_set t(keys.begin(), keys.end());
+    auto f = rmr::freeze(t);
+    EXPECT_TRUE(std::equal(f.begin(), f.end(), t.begin(), t.end()));
+}
+
+TEST(frozen_trie, empty) {
+    trie_set t;
+    auto f = rmr::freeze(t);
+    rmr::frozen_trie_set<127> g;
+
+    EXPECT_TRUE(f.empty());
+    EXPECT_EQ(f.end(), f.find(""));
+    EXPECT_EQ(f.end(), f.longest_match("abc"));
+    EXPECT_EQ(g.end(), g.find("a"));
+    auto [first, last] = f.prefixed_with("");
+    EXPECT_EQ(first, last);
+}
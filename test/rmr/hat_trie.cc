@@ -0,0 +1,133 @@
+// Armor
+//
+// Copyright Ron Mordechai, 2018
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "assoc.h"
+
+namespace {
+
+// Enough keys to burst the root bucket and several below it.
+std::vector<std::string> random_keys(std::size_t n, std::size_t max_length) {
+    std::default_random_engine engine(42);
+    std::uniform_int_distribution<std::size_t> length(0, max_length);
+    std::uniform_int_distribution<int> symbol('a', 'e');
+
+    std::vector<std::string> keys;
+    for (std::size_t i = 0; i < n; ++i) {
+        std::string k(length(engine), 0);
+        for (auto& c : k) c = static_cast<char>(symbol(engine));
+        keys.push_back(k);
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+} // namespace
+
+TEST(hat_trie, iteration_matches_trie_order) {
+    auto keys = random_keys(5000, 8);
+    std::shuffle(keys.begin(), keys.end(), std::default_random_engine(7));
+
+    hat_trie_set t(keys.begin(), keys.end());
+    trie_set expected(keys.begin(), keys.end());
+
+    EXPECT_EQ(expected.size(), t.size());
+    EXPECT_TRUE(std::equal(t.begin(), t.end(), expected.begin(), expected.end()));
+    EXPECT_TRUE(std::equal(t.rbegin(), t.rend(), expected.rbegin(), expected.rend()));
+}
+
+TEST(hat_trie, find_after_bursts) {
+    auto keys = random_keys(5000, 8);
+    hat_trie_map t;
+    for (std::size_t i = 0; i < keys.size(); ++i) t.emplace(keys[i], static_cast<int>(i));
+
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        auto it = t.find(keys[i]);
+        ASSERT_NE(t.end(), it) << "key " << keys[i];
+        EXPECT_EQ(static_cast<int>(i), it->second);
+    }
+    EXPECT_EQ(t.end(), t.find("f"));
+    EXPECT_EQ(t.end(), t.find("aaaaaaaaa"));
+}
+
+TEST(hat_trie, erase_keeps_order) {
+    auto keys = random_keys(3000, 7);
+    hat_trie_set t(keys.begin(), keys.end());
+    trie_set expected(keys.begin(), keys.end());
+
+    std::shuffle(keys.begin(), keys.end(), std::default_random_engine(7));
+    for (std::size_t i = 0; i < keys.size(); i += 2) {
+        EXPECT_EQ(1u, t.erase(keys[i]));
+        expected.erase(keys[i]);
+    }
+    EXPECT_EQ(expected.size(), t.size());
+    EXPECT_TRUE(std::equal(t.begin(), t.end(), expected.begin(), expected.end()));
+
+    t.erase(t.begin(), t.end());
+    EXPECT_EQ(0u, t.size());
+    EXPECT_EQ(t.end(), t.begin());
+}
+
+TEST(hat_trie, erase_returns_next) {
+    auto keys = random_keys(2000, 6);
+    hat_trie_set t(keys.begin(), keys.end());
+
+    std::size_t n = 0;
+    for (auto it = t.begin(); it != t.end(); ++n) {
+        if (n % 3 == 0) it = t.erase(it);
+        else ++it;
+    }
+    trie_set expected;
+    for (std::size_t i = 0; i < keys.size(); ++i) if (i % 3 != 0) expected.insert(keys[i]);
+    EXPECT_TRUE(std::equal(t.begin(), t.end(), expected.begin(), expected.end()));
+}
+
+TEST(hat_trie, prefixed_with_matches_trie) {
+    auto keys = random_keys(3000, 7);
+    hat_trie_set t(keys.begin(), keys.end());
+    trie_set expected(keys.begin(), keys.end());
+
+    for (auto prefix : { "", "a", "ab", "abc", "eeee", "ca", "abcdeabcd", "bad" }) {
+        auto [first, last] = t.prefixed_with(prefix);
+        auto [efirst, elast] = expected.prefixed_with(prefix);
+        EXPECT_TRUE(std::equal(first, last, efirst, elast)) << "prefix " << prefix;
+    }
+}
+
+TEST(hat_trie, longest_match_matches_trie) {
+    auto keys = random_keys(1000, 6);
+    hat_trie_set t(keys.begin(), keys.end());
+    trie_set expected(keys.begin(), keys.end());
+
+    for (auto& k : random_keys(300, 10)) {
+        auto it = t.longest_match(k);
+        auto eit = expected.longest_match(k);
+        if (eit == expected.end()) EXPECT_EQ(t.end(), it) << "key " << k;
+        else                       EXPECT_EQ(*eit, *it) << "key " << k;
+    }
+}
+
+TEST(hat_trie, copy_and_move_after_bursts) {
+    auto keys = random_keys(3000, 7);
+    hat_trie_set t(keys.begin(), keys.end());
+
+    hat_trie_set copy(t);
+    EXPECT_TRUE(std::equal(t.begin(), t.end(), copy.begin(), copy.end()));
+
+    hat_trie_set moved(std::move(copy));
+    EXPECT_EQ(0u, copy.size());
+    EXPECT_TRUE(std::equal(t.begin(), t.end(), moved.begin(), moved.end()));
+
+    hat_trie_set other{ "x" };
+    other.swap(moved);
+    EXPECT_TRUE(std::equal(t.begin(), t.end(), other.begin(), other.end()));
+    EXPECT_EQ(1u, moved.size());
+}
@@ -0,0 +1,71 @@
+// Armor
+//
+// Copyright Ron Mordechai, 2018
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <set>
+#include <vector>
+
+#include "assoc.h"
+
+#include <rmr/detail/node_storage.h>
+
+struct pool_node { pool_node* children[4]; int value; };
+
+using node_pool = rmr::detail::node_pool<pool_node, 1024>;
+using node_allocator = test::counting_allocator<pool_node, 1>;
+
+TEST(node_pool, reuses_destroyed_nodes) {
+    node_allocator alloc;
+    node_pool pool;
+
+    pool_node* n = pool.create(alloc);
+    pool.destroy(alloc, n);
+    EXPECT_EQ(n, pool.create(alloc));
+
+    pool.release(alloc);
+}
+
+TEST(node_pool, allocates_in_chunks) {
+    node_allocator alloc;
+    node_pool pool;
+
+    pool.create(alloc);
+    std::size_t chunk_bytes = node_allocator::bytes_allocated;
+    EXPECT_EQ(node_pool::chunk_size * sizeof(pool_node), chunk_bytes);
+
+    for (std::size_t i = 1; i < node_pool::chunk_size - 1; ++i) pool.create(alloc);
+    EXPECT_EQ(chunk_bytes, node_allocator::bytes_allocated);
+
+    pool.create(alloc);
+    EXPECT_EQ(2 * chunk_bytes, node_allocator::bytes_allocated);
+
+    pool.release(alloc);
+    EXPECT_EQ(0u, node_allocator::bytes_allocated);
+}
+
+TEST(node_pool, nodes_are_distinct) {
+    node_allocator alloc;
+    node_pool pool;
+
+    std::set<pool_node*> nodes;
+    for (std::size_t i = 0; i < 3 * node_pool::chunk_size; ++i) nodes.insert(pool.create(alloc));
+    EXPECT_EQ(3 * node_pool::chunk_size, nodes.size());
+
+    pool.release(alloc);
+}
+
+TEST(node_pool, move_transfers_chunks) {
+    node_allocator alloc;
+    node_pool pool;
+    pool.create(alloc);
+
+    node_pool other(std::move(pool));
+    pool.release(alloc); // NOLINT(bugprone-use-after-move)
+    EXPECT_NE(0u, node_allocator::bytes_allocated);
+
+    other.release(alloc);
+    EXPECT_EQ(0u, node_allocator::bytes_allocated);
+}
@@ -0,0 +1,93 @@
+// Armor
+//
+// Copyright Ron Mordechai, 2018
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "assoc.h"
+
+namespace {
+
+std::vector<std::string> random_keys(std::size_t n, std::size_t max_length) {
+    std::default_random_engine engine(42);
+    std::uniform_int_distribution<std::size_t> length(0, max_length);
+    std::uniform_int_distribution<int> symbol('a', 'd');
+
+    std::vector<std::string> keys;
+    for (std::size_t i = 0; i < n; ++i) {
+        std::string k(length(engine), 0);
+        for (auto& c : k) c = static_cast<char>(symbol(engine));
+        keys.push_back(k);
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+} // namespace
+
+TEST(patricia_trie, iteration_matches_trie_order) {
+    auto keys = random_keys(500, 8);
+    std::shuffle(keys.begin(), keys.end(), std::default_random_engine(7));
+
+    patricia_trie_set t(keys.begin(), keys.end());
+    trie_set expected(keys.begin(), keys.end());
+
+    EXPECT_EQ(expected.size(), t.size());
+    EXPECT_TRUE(std::equal(t.begin(), t.end(), expected.begin(), expected.end()));
+    EXPECT_TRUE(std::equal(t.rbegin(), t.rend(), expected.rbegin(), expected.rend()));
+}
+
+TEST(patricia_trie, erase_keeps_order) {
+    auto keys = random_keys(300, 6);
+    patricia_trie_set t(keys.begin(), keys.end());
+    trie_set expected(keys.begin(), keys.end());
+
+    std::shuffle(keys.begin(), keys.end(), std::default_random_engine(7));
+    for (std::size_t i = 0; i < keys.size(); i += 2) {
+        EXPECT_EQ(1u, t.erase(keys[i]));
+        expected.erase(keys[i]);
+    }
+    EXPECT_EQ(expected.size(), t.size());
+    EXPECT_TRUE(std::equal(t.begin(), t.end(), expected.begin(), expected.end()));
+}
+
+TEST(patricia_trie, prefixed_with_matches_trie) {
+    auto keys = random_keys(300, 6);
+    patricia_trie_set t(keys.begin(), keys.end());
+    trie_set expected(keys.begin(), keys.end());
+
+    for (auto prefix : { "", "a", "ab", "abc", "dddd", "ca", "abcdabcd" }) {
+        auto [first, last] = t.prefixed_with(prefix);
+        auto [efirst, elast] = expected.prefixed_with(prefix);
+        EXPECT_TRUE(std::equal(first, last, efirst, elast)) << "prefix " << prefix;
+    }
+}
+
+TEST(patricia_trie, longest_match_matches_trie) {
+    auto keys = random_keys(100, 6);
+    patricia_trie_set t(keys.begin(), keys.end());
+    trie_set expected(keys.begin(), keys.end());
+
+    for (auto& k : random_keys(100, 10)) {
+        auto it = t.longest_match(k);
+        auto eit = expected.longest_match(k);
+        if (eit == expected.end()) EXPECT_EQ(t.end(), it) << "key " << k;
+        else                       EXPECT_EQ(*eit, *it) << "key " << k;
+    }
+}
+
+TEST(patricia_trie, long_keys_sharing_prefixes) {
+    std::string prefix(200, 'x');
+    patricia_trie_set t{ prefix, prefix + "a", prefix + "ab", prefix.substr(0, 100) + "y" };
+
+    EXPECT_EQ(4u, t.size());
+    EXPECT_EQ(prefix + "ab", *t.longest_match(prefix + "abc"));
+    EXPECT_EQ(prefix, *t.longest_match(prefix + "b"));
+    EXPECT_EQ(3, std::distance(t.prefixed_with(prefix).first, t.prefixed_with(prefix).second));
+}
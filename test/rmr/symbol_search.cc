@@ -0,0 +1,41 @@
+// Armor
+//
+// Copyright Ron Mordechai, 2018
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+#include <rmr/detail/symbol_search.h>
+
+namespace {
+
+template <typename Symbol, std::size_t N>
+void expect_matches_scalar(std::size_t max_symbol) {
+    Symbol keys[N];
+    for (std::size_t j = 0; j < N; ++j) keys[j] = static_cast<Symbol>(max_symbol - 3 * j);
+
+    for (std::size_t count = 0; count <= N; ++count) {
+        for (std::size_t s = 0; s <= max_symbol; ++s) {
+            EXPECT_EQ(rmr::detail::find_symbol_scalar(keys, count, s), rmr::detail::find_symbol(keys, count, s))
+                << "count " << count << ", symbol " << s;
+        }
+    }
+}
+
+} // namespace
+
+TEST(symbol_search, uint8_inline) { expect_matches_scalar<std::uint8_t, 4>(0xff); }
+TEST(symbol_search, uint8_sparse) { expect_matches_scalar<std::uint8_t, 16>(0xff); }
+TEST(symbol_search, uint16_inline) { expect_matches_scalar<std::uint16_t, 4>(0x1ff); }
+TEST(symbol_search, uint16_sparse) { expect_matches_scalar<std::uint16_t, 16>(0x1ff); }
+
+TEST(symbol_search, ignores_entries_past_count) {
+    std::uint8_t keys[16] = { 1, 2, 3, 4, 5 };
+    EXPECT_EQ(4u, rmr::detail::find_symbol(keys, 5, 5));
+    EXPECT_EQ(4u, rmr::detail::find_symbol(keys, 4, 5));
+    EXPECT_EQ(3u, rmr::detail::find_symbol(keys, 3, 0));
+}
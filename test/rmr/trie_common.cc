@@ -5,6 +5,10 @@
 // Distributed under the Boost Software License, Version 1.0.
 // (See accompanying file LICENSE.txt or copy at http://boost.org/LICENSE_1_0.txt)
 
+#include <algorithm>
+#include <random>
+#include <vector>
+
 #include "assoc.h"
 
 template <typename T>
@@ -44,3 +48,29 @@ TYPED_TEST(trie_common, key_map) {
     TypeParam t;
     EXPECT_TRUE((std::is_same_v<decltype(t.key_map()), typename TypeParam::key_mapper>));
 }
+
+TYPED_TEST(trie_common, assign_sorted_matches_insert) {
+    std::default_random_engine engine(42);
+    std::uniform_int_distribution<std::size_t> length(0, 6);
+    std::uniform_int_distribution<int> symbol('a', 'e');
+
+    TypeParam expected;
+    for (int i = 0; i < 2000; ++i) {
+        std::string k(length(engine), 0);
+        for (auto& c : k) c = static_cast<char>(symbol(engine));
+        expected.insert(TestFixture::key_to_value(k));
+    }
+
+    std::vector<typename TypeParam::value_type> v(expected.begin(), expected.end());
+    TypeParam t(rmr::sorted_input, v.begin(), v.end());
+    EXPECT_EQ(expected, t);
+    EXPECT_TRUE(std::equal(t.rbegin(), t.rend(), expected.rbegin(), expected.rend()));
+
+    for (std::size_t i = 0; i < v.size(); i += 2) {
+        auto key = TestFixture::value_to_key(v[i]);
+        EXPECT_NE(t.end(), t.find(key)) << "key " << key;
+        t.erase(key);
+        expected.erase(key);
+    }
+    EXPECT_EQ(expected, t);
+}